@@ -0,0 +1,154 @@
+// Size and speed of the chunk encoding, against the raw grid and the json of the old saves
+// Usage: bench-chunk_codec [chunks] [repetitions]
+
+#include "components/noise.hpp"
+#include "items.hpp"
+#include "misc/snapshot.hpp"
+#include "scenes/chunk.hpp"
+#include "scenes/region.hpp"
+#include "third_party/Eigen/Core"
+#include "third_party/rapidjson/document.h"
+#include "third_party/rapidjson/stringbuffer.h"
+#include "third_party/rapidjson/writer.h"
+
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr const static std::size_t GRID_BYTES = Chunk::CHUNK_WIDTH * Chunk::MAX_HEIGHT * sizeof(std::uint16_t);
+// The format byte, the position and the grid
+constexpr const static std::size_t RAW_BYTES = 1 + sizeof(std::int64_t) + GRID_BYTES;
+
+[[nodiscard]] std::vector<std::byte> encode(const Chunk& chunk) {
+	utils::snapshot_writer writer;
+	chunk.save(writer);
+
+	return writer.release();
+}
+
+// The blocks as `[type, [x, y]]`, like the saves before region files
+[[nodiscard]] std::size_t jsonSize(const Chunk& chunk) {
+	rapidjson::Document document;
+	document.SetArray();
+	auto& allocator = document.GetAllocator();
+
+	chunk.each([&](const Eigen::Vector2i& position, const Components::Item type) {
+		rapidjson::Value block(rapidjson::kArrayType);
+		rapidjson::Value where(rapidjson::kArrayType);
+
+		where.PushBack(position.x(), allocator).PushBack(position.y(), allocator);
+		block.PushBack(static_cast<std::uint64_t>(type), allocator).PushBack(where, allocator);
+		document.PushBack(block, allocator);
+	});
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	document.Accept(writer);
+
+	return buffer.GetSize();
+}
+
+template <typename Type> void fill(Chunk& chunk, Type&& type) {
+	const int left = static_cast<int>(chunk.getPosition() * Chunk::CHUNK_WIDTH);
+
+	for (int x = left; x < left + Chunk::CHUNK_WIDTH; ++x) {
+		for (int y = 0; y < Chunk::MAX_HEIGHT; ++y) {
+			chunk.setBlock(Eigen::Vector2i(x, y), type());
+		}
+	}
+}
+
+double microsecondsSince(const Clock::time_point start) {
+	return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+} // namespace
+
+int main(int argc, char** argv) {
+	const int count = std::max(argc > 1 ? std::atoi(argv[1]) : 256, 4);
+	const int repetitions = argc > 2 ? std::atoi(argv[2]) : 40;
+
+	const NoiseGenerator noise(4242);
+	std::vector<std::unique_ptr<Chunk>> chunks;
+	for (int i = -count / 2; i < count - count / 2; ++i) {
+		chunks.emplace_back(std::make_unique<Chunk>(&noise, i));
+	}
+
+	// Some player edits, and one chunk of noise
+	std::mt19937 random(7);
+	for (int edit = 0; edit < 2000; ++edit) {
+		Chunk& chunk = *chunks[random() % chunks.size()];
+		const Eigen::Vector2i position(chunk.getPosition() * Chunk::CHUNK_WIDTH + random() % Chunk::CHUNK_WIDTH,
+					       random() % Chunk::MAX_HEIGHT);
+
+		chunk.setBlock(position, static_cast<Components::Item>(random() % 40));
+	}
+
+	fill(*chunks[3], [&random] { return static_cast<Components::Item>(random() % 44); });
+
+	std::size_t total = 0;
+	std::size_t largest = 0;
+	std::size_t json = 0;
+	std::vector<std::vector<std::byte>> encoded;
+	for (const auto& chunk : chunks) {
+		encoded.emplace_back(encode(*chunk));
+		total += encoded.back().size();
+		largest = std::max(largest, encoded.back().size());
+		json += jsonSize(*chunk);
+	}
+
+	Chunk air(&noise, 0);
+	fill(air, [] { return Components::Item::AIR; });
+
+	auto start = Clock::now();
+	for (int repetition = 0; repetition < repetitions; ++repetition) {
+		for (std::size_t i = 0; i < chunks.size(); ++i) {
+			encoded[i] = encode(*chunks[i]);
+		}
+	}
+
+	const double encoding = microsecondsSince(start) / (repetitions * chunks.size());
+
+	std::size_t decoded = 0;
+	start = Clock::now();
+	for (int repetition = 0; repetition < repetitions; ++repetition) {
+		for (const auto& data : encoded) {
+			decoded += Chunk::load(data) != nullptr;
+		}
+	}
+
+	const double decoding = microsecondsSince(start) / (repetitions * chunks.size());
+
+	// One region of generated chunks, each written once
+	const std::string path = "bench-chunk_codec.region";
+	{
+		Region region(path);
+		for (std::int64_t position = 0; position < Region::REGION_WIDTH; ++position) {
+			region.write(position, encode(Chunk(&noise, position)));
+		}
+	}
+
+	SDL_PathInfo info{};
+	SDL_GetPathInfo(path.c_str(), &info);
+	SDL_RemovePath(path.c_str());
+
+	SDL_Log("%zu chunks with 2000 random edits and one chunk of noise, %zu decoded", chunks.size(), decoded);
+	SDL_Log("size:   %zu B on average, %zu B for the noise chunk, %zu B all air", total / chunks.size(), largest,
+		encode(air).size());
+	SDL_Log("        vs %zu B for the raw grid and %zu B as json", RAW_BYTES, json / chunks.size());
+	SDL_Log("encode: %.2f us per chunk, %.0f chunks/s, %.0f MB/s of grid", encoding, 1e6 / encoding,
+		GRID_BYTES / encoding);
+	SDL_Log("decode: %.2f us per chunk, %.0f chunks/s, %.0f MB/s of grid", decoding, 1e6 / decoding,
+		GRID_BYTES / decoding);
+	SDL_Log("region file for %d chunks: %" PRIu64 " B", static_cast<int>(Region::REGION_WIDTH), info.size);
+}
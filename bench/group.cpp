@@ -0,0 +1,148 @@
+// The block loops of the renderer and the physics, with single pool views and then with the block group
+// Usage: bench-group [frames]
+
+#include "components.hpp"
+#include "items.hpp"
+#include "scene.hpp"
+#include "third_party/Eigen/Core"
+
+#include <SDL3/SDL.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+using Components::block;
+using Components::collision;
+using Components::position;
+using Components::texture;
+
+constexpr const static int CHUNK_WIDTH = 16;
+constexpr const static int CHUNK_HEIGHT = 128;
+
+// About 60% solid blocks, with an item every 20 blocks sharing the texture and collision pools
+std::vector<EntityID> spawnChunk(Scene& scene, std::mt19937& random, const int chunk) {
+	std::vector<EntityID> blocks;
+
+	for (int x = 0; x < CHUNK_WIDTH; ++x) {
+		for (int y = 0; y < CHUNK_HEIGHT; ++y) {
+			if (random() % 10 < 4) {
+				continue;
+			}
+
+			const EntityID entity = scene.newEntity();
+			const Eigen::Vector2i tile(chunk * CHUNK_WIDTH + x, y);
+
+			scene.emplace<block>(entity, Components::Item::STONE, tile);
+			scene.emplace<texture>(entity, nullptr);
+			scene.emplace<collision>(entity, Eigen::Vector2f(0, 0), Eigen::Vector2f(112, 112), true);
+			blocks.emplace_back(entity);
+
+			if (random() % 20 == 0) {
+				const EntityID item = scene.newEntity();
+				scene.emplace<position>(item, Eigen::Vector2f(x * 112.0f, y * 112.0f));
+				scene.emplace<texture>(item, nullptr);
+				scene.emplace<collision>(item, Eigen::Vector2f(0, 0), Eigen::Vector2f(30, 30));
+			}
+		}
+	}
+
+	return blocks;
+}
+
+bool overlaps(const position& player, const collision& playerBox, const block& other, const collision& box) {
+	const Eigen::Vector2f minA = player.mPosition + playerBox.mOffset;
+	const Eigen::Vector2f maxA = minA + playerBox.mSize;
+	const Eigen::Vector2f minB = other.mPosition.cast<float>() * block::BLOCK_SIZE + box.mOffset;
+	const Eigen::Vector2f maxB = minB + box.mSize;
+
+	return !(maxA.x() <= minB.x() || maxA.y() <= minB.y() || maxB.x() <= minA.x() || maxB.y() <= minA.y());
+}
+
+// The culling and instance data of `RenderSystem::draw`
+void cull(std::vector<int>& data, const block& other) {
+	const Eigen::Vector2i& tile = other.mPosition;
+
+	if (tile.y() >= 50 && tile.y() <= 70 && tile.x() >= 10 && tile.x() <= 40) {
+		data.emplace_back(tile.x());
+		data.emplace_back(tile.y());
+		data.emplace_back(static_cast<int>(other.mType));
+	}
+}
+
+template <typename Func> double microsecondsPerFrame(const int frames, Func&& frame) {
+	const auto start = Clock::now();
+	for (int i = 0; i < frames; ++i) {
+		frame();
+	}
+
+	return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / frames;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+	Scene scene;
+	std::mt19937 random(7);
+	const std::vector<EntityID> unloaded = spawnChunk(scene, random, 0);
+	for (int chunk = 1; chunk < 4; ++chunk) {
+		(void)spawnChunk(scene, random, chunk);
+	}
+
+	// Unload the left chunk, like `Chunk::save`, so the pools have holes refilled by later entities
+	for (const EntityID entity : unloaded) {
+		scene.erase(entity);
+	}
+
+	const EntityID player = scene.newEntity();
+	scene.emplace<position>(player, Eigen::Vector2f(1.5f * CHUNK_WIDTH * 112, 60 * 112.0f));
+	scene.emplace<collision>(player, Eigen::Vector2f(0, 0), Eigen::Vector2f(80, 200));
+
+	std::vector<int> data;
+	long hits = 0;
+	const auto drawView = [&] {
+		data.clear();
+		for (const auto& [entity, other] : scene.view<block>().each()) {
+			cull(data, other);
+		}
+	};
+	const auto collideView = [&] {
+		for (const EntityID entity : scene.view<collision, block>()) {
+			hits += overlaps(scene.get<position>(player), scene.get<collision>(player),
+					 scene.get<block>(entity), scene.get<collision>(entity));
+		}
+	};
+
+	const double viewDraw = microsecondsPerFrame(frames, drawView);
+	const double viewCollide = microsecondsPerFrame(frames, collideView);
+
+	// Creating the group sorts the owned pools, from here on the views see the grouped order too
+	const auto drawGroup = [&] {
+		data.clear();
+		for (const auto& [entity, other, box, sprite] : scene.group<block, collision, texture>().each()) {
+			cull(data, other);
+		}
+	};
+	const auto collideGroup = [&] {
+		for (const auto& [entity, other, box, sprite] : scene.group<block, collision, texture>().each()) {
+			hits += overlaps(scene.get<position>(player), scene.get<collision>(player), other, box);
+		}
+	};
+
+	const double groupDraw = microsecondsPerFrame(frames, drawGroup);
+	const double groupCollide = microsecondsPerFrame(frames, collideGroup);
+
+	std::size_t blocks = 0;
+	for ([[maybe_unused]] const EntityID entity : scene.view<block>()) {
+		++blocks;
+	}
+
+	SDL_Log("%zu blocks, %d frames, %ld hits", blocks, frames, hits);
+	SDL_Log("                      without group   with group");
+	SDL_Log("draw blocks loop    %10.1f us   %10.1f us", viewDraw, groupDraw);
+	SDL_Log("collide player loop %10.1f us   %10.1f us", viewCollide, groupCollide);
+}
@@ -0,0 +1,116 @@
+// Noise throughput on the path this build takes, and what the noise makes of the chunks
+// Usage: bench-noise [columns] [chunks]
+// Build with -DOPTIMIZE=ON for the native SIMD width, or add -DNOISE_SCALAR to the flags for the scalar loop
+
+#include "components/noise.hpp"
+#include "items.hpp"
+#include "scenes/chunk.hpp"
+#include "third_party/Eigen/Core"
+
+#include <SDL3/SDL.h>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+using Feature = NoiseGenerator::Feature;
+
+// Same choice as noise.cpp
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(NOISE_SCALAR)
+#ifdef __AVX2__
+constexpr const static char* PATH = "8 lanes (AVX2)";
+#else
+constexpr const static char* PATH = "4 lanes (SSE or NEON)";
+#endif
+#else
+constexpr const static char* PATH = "scalar";
+#endif
+
+double secondsSince(const Clock::time_point start) {
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// The noise before the Perlin noise, two sines per column
+float sineNoise(const std::uint64_t seed, const std::int64_t x) {
+	const double position = static_cast<double>(static_cast<std::uint64_t>(x) ^ seed);
+
+	return static_cast<float>(0.4 * (std::sin(0.2 * position) + 0.9 * std::sin(0.1 * 3.14159 * position)));
+}
+} // namespace
+
+int main(int argc, char** argv) {
+	const int columns = argc > 1 ? std::atoi(argv[1]) : 200000;
+	const int count = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+	const NoiseGenerator noise(1234);
+	float sink = 0.0f;
+
+	// Caves and ores sample up a column, the heights along a chunk wide row
+	std::vector<float> column(Chunk::MAX_HEIGHT);
+	auto start = Clock::now();
+	for (int x = 0; x < columns; ++x) {
+		noise.getNoise(Feature::CAVE, x, 0, column, {32, 1});
+		sink += column[3];
+	}
+
+	const double samples2D = columns * static_cast<double>(Chunk::MAX_HEIGHT) / secondsSince(start);
+
+	std::vector<float> row(Chunk::CHUNK_WIDTH);
+	const int rows = columns * Chunk::MAX_HEIGHT / Chunk::CHUNK_WIDTH;
+	start = Clock::now();
+	for (int i = 0; i < rows; ++i) {
+		noise.getNoise(Feature::HEIGHT, static_cast<std::int64_t>(i) * Chunk::CHUNK_WIDTH, row, {64, 1});
+		sink += row[2];
+	}
+
+	const double samples1D = rows * static_cast<double>(Chunk::CHUNK_WIDTH) / secondsSince(start);
+
+	start = Clock::now();
+	for (int x = 0; x < columns * Chunk::MAX_HEIGHT; ++x) {
+		sink += sineNoise(1234, x);
+	}
+
+	const double samplesSine = columns * static_cast<double>(Chunk::MAX_HEIGHT) / secondsSince(start);
+
+	start = Clock::now();
+	for (int i = 0; i < count; ++i) {
+		const Chunk chunk(&noise, i);
+	}
+
+	const double generation = secondsSince(start) * 1e6 / count;
+
+	// The caves stay 4 blocks under the surface and 2 above the bottom, count how much of that they carve
+	long underground = 0;
+	long carved = 0;
+	long ores = 0;
+	for (int i = -count / 2; i < count - count / 2; ++i) {
+		const Chunk chunk(&noise, i);
+		const int left = i * Chunk::CHUNK_WIDTH;
+
+		for (int x = left; x < left + Chunk::CHUNK_WIDTH; ++x) {
+			const int surface = static_cast<int>(Chunk::surfaceOf(&noise, x));
+
+			for (int y = 2; y + 4 < surface; ++y) {
+				++underground;
+				carved += chunk.getBlock(Eigen::Vector2i(x, y)) == Components::Item::AIR;
+			}
+		}
+
+		chunk.each([&ores](const Eigen::Vector2i&, const Components::Item type) {
+			ores += type == Components::Item::COAL_ORE || type == Components::Item::IRON_ORE ||
+				type == Components::Item::DIAMOND_ORE;
+		});
+	}
+
+	SDL_Log("Noise path: %s, %d columns, %d chunks, checksum %.1f", PATH, columns, count, sink);
+	SDL_Log("2D:   %6.1f M samples/s", samples2D / 1e6);
+	SDL_Log("1D:   %6.1f M samples/s", samples1D / 1e6);
+	SDL_Log("sine: %6.1f M samples/s, the noise before", samplesSine / 1e6);
+	SDL_Log("A chunk generates in %.1f us", generation);
+	SDL_Log("Caves take %.1f%% of the stone under the surface, %.1f ore blocks per chunk",
+		100.0 * carved / underground, static_cast<double>(ores) / count);
+}
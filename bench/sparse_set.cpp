@@ -0,0 +1,115 @@
+// Memory and lookup cost of the paged sparse index against the flat index it replaced
+// Usage: bench-sparse_set [entities] [lookups]
+
+#include "managers/entityManager.hpp"
+#include "misc/sparse_set.hpp"
+
+#include <SDL3/SDL.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct component {
+	float x;
+	float y;
+};
+
+// The old layout: one sparse slot for every ID up to the largest one, grown with emplace_back
+struct flat_set {
+	std::vector<std::uintptr_t> mSparse;
+	std::vector<EntityID> mPacked;
+	std::vector<component> mComponents;
+
+	void emplace(const EntityID entity, const component value) {
+		while (mSparse.size() <= entity) {
+			mSparse.emplace_back(0);
+		}
+
+		mSparse[entity] = mPacked.size();
+		mPacked.emplace_back(entity);
+		mComponents.emplace_back(value);
+	}
+
+	[[nodiscard]] bool contains(const EntityID entity) const noexcept {
+		return entity < mSparse.size() && mSparse[entity] < mPacked.size() &&
+		       mPacked[mSparse[entity]] == entity;
+	}
+
+	[[nodiscard]] const component& get(const EntityID entity) const noexcept {
+		return mComponents[mSparse[entity]];
+	}
+
+	[[nodiscard]] std::size_t sparse_bytes() const noexcept { return mSparse.capacity() * sizeof(std::uintptr_t); }
+};
+
+struct result {
+	std::size_t bytes;
+	double contains;
+	double get;
+};
+
+// Nanoseconds per lookup, half of the contains probes miss
+template <typename Set> result measure(const std::vector<EntityID>& entities, const std::size_t lookups) {
+	Set set;
+	for (const EntityID entity : entities) {
+		set.emplace(entity, component{1.0f, 2.0f});
+	}
+
+	std::mt19937_64 random(1);
+	std::vector<EntityID> probes(lookups);
+	std::vector<EntityID> hits(lookups);
+	for (std::size_t i = 0; i < lookups; ++i) {
+		hits[i] = entities[random() % entities.size()];
+		probes[i] = hits[i] + random() % 2;
+	}
+
+	const auto start = Clock::now();
+	std::size_t found = 0;
+	for (const EntityID probe : probes) {
+		found += set.contains(probe);
+	}
+
+	const auto middle = Clock::now();
+	float sum = 0.0f;
+	for (const EntityID hit : hits) {
+		sum += set.get(hit).x;
+	}
+
+	const auto end = Clock::now();
+
+	// Keeps the loops from being optimized out
+	if (found == 0 || sum == 0.0f) {
+		SDL_Log("\033[33mNo lookups hit\033[0m");
+	}
+
+	return {set.sparse_bytes(), std::chrono::duration<double, std::nano>(middle - start).count() / lookups,
+		std::chrono::duration<double, std::nano>(end - middle).count() / lookups};
+}
+} // namespace
+
+int main(int argc, char** argv) {
+	const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 500;
+	const std::size_t lookups = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000000;
+
+	SDL_Log("%zu entities at the top of the ID range, %zu lookups", count, lookups);
+	SDL_Log("   max ID    flat sparse   paged sparse   contains flat/paged   get flat/paged");
+
+	for (const std::size_t maxID : {std::size_t(10000), std::size_t(300000), std::size_t(3000000)}) {
+		std::vector<EntityID> entities;
+		for (std::size_t i = 0; i < count; ++i) {
+			entities.emplace_back(maxID - count * 4 + i * 4 + 1);
+		}
+
+		const result flat = measure<flat_set>(entities, lookups);
+		const result paged = measure<utils::sparse_set<component>>(entities, lookups);
+
+		SDL_Log("%9zu   %9.1f KB   %9.1f KB     %5.2f / %5.2f ns      %5.2f / %5.2f ns", maxID,
+			flat.bytes / 1000.0, paged.bytes / 1000.0, flat.contains, paged.contains, flat.get, paged.get);
+	}
+}
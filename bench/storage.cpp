@@ -0,0 +1,130 @@
+// The storage backend under the block and item workloads, build once with and once without ARCHETYPE to compare
+// Usage: bench-storage [chunks] [frames]
+
+#include "components.hpp"
+#include "items.hpp"
+#include "scene.hpp"
+#include "third_party/Eigen/Core"
+
+#include <SDL3/SDL.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+using Components::block;
+using Components::collision;
+using Components::item;
+using Components::position;
+using Components::texture;
+using Components::velocity;
+
+constexpr const static int CHUNK_WIDTH = 16;
+constexpr const static int CHUNK_HEIGHT = 128;
+constexpr const static int CHUNK_BLOCKS = CHUNK_WIDTH * CHUNK_HEIGHT;
+constexpr const static int ITEMS = 2000;
+
+double microsecondsSince(const Clock::time_point start) {
+	return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// A full chunk of blocks, created and filled a component at a time
+void loadChunk(Scene& scene, const int chunk) {
+	const std::vector<EntityID> entities = scene.createMany(CHUNK_BLOCKS);
+	std::vector<block> blocks;
+	std::vector<texture> textures;
+	std::vector<collision> collisions;
+	std::vector<position> positions;
+
+	for (int i = 0; i < CHUNK_BLOCKS; ++i) {
+		const Eigen::Vector2i tile(chunk * CHUNK_WIDTH + i / CHUNK_HEIGHT, i % CHUNK_HEIGHT);
+
+		blocks.emplace_back(Components::Item::STONE, tile);
+		textures.emplace_back(nullptr);
+		collisions.emplace_back(Eigen::Vector2f(0, 0), Eigen::Vector2f(1, 1), true);
+		positions.emplace_back(tile.cast<float>());
+	}
+
+	scene.emplaceRange<block>(entities, std::move(blocks));
+	scene.emplaceRange<texture>(entities, std::move(textures));
+	scene.emplaceRange<collision>(entities, std::move(collisions));
+	scene.emplaceRange<position>(entities, std::move(positions));
+}
+} // namespace
+
+int main(int argc, char** argv) {
+	const int chunks = argc > 1 ? std::atoi(argv[1]) : 20;
+	const int frames = argc > 2 ? std::atoi(argv[2]) : 200;
+
+	Scene scene;
+	auto start = Clock::now();
+	for (int chunk = 0; chunk < chunks; ++chunk) {
+		loadChunk(scene, chunk);
+	}
+
+	const double load = microsecondsSince(start) / chunks;
+
+	const std::vector<EntityID> items = scene.createMany(ITEMS);
+	for (int i = 0; i < ITEMS; ++i) {
+		scene.emplace<position>(items[i], Eigen::Vector2f(i % 300, 130));
+		scene.emplace<velocity>(items[i], Eigen::Vector2f(0.5f, -1));
+		scene.emplace<collision>(items[i], Eigen::Vector2f(0, 0), Eigen::Vector2f(0.3f, 0.3f));
+		scene.emplace<item>(items[i], Components::Item::STONE);
+	}
+
+	// The item integration, then the pickup check against every item
+	std::size_t picked = 0;
+	start = Clock::now();
+	for (int frame = 0; frame < frames; ++frame) {
+		scene.view<position, velocity, collision>().each(
+			[](const EntityID, position& where, velocity& speed, collision&) {
+				where.mPosition += speed.mVelocity * 0.016f;
+				speed.mVelocity.y() -= 0.1f;
+			});
+
+		for (const auto& [entity, where, type] : scene.view<position, item>().each()) {
+			picked += where.mPosition.x() < 1.0f;
+		}
+	}
+
+	const double physics = microsecondsSince(start) / frames;
+
+	// The instance data of `RenderSystem::draw`, without the culling
+	std::vector<int> data;
+	start = Clock::now();
+	for (int frame = 0; frame < frames; ++frame) {
+		data.clear();
+		for (const auto& [entity, other] : scene.view<block>().each()) {
+			data.emplace_back(other.mPosition.x());
+			data.emplace_back(other.mPosition.y());
+			data.emplace_back(static_cast<int>(other.mType));
+		}
+	}
+
+	const double render = microsecondsSince(start) / frames;
+
+	// Unload half of the blocks one entity at a time
+	std::vector<EntityID> blocks;
+	for (const EntityID entity : scene.view<block>()) {
+		blocks.emplace_back(entity);
+	}
+
+	start = Clock::now();
+	for (std::size_t i = 0; i < blocks.size() / 2; ++i) {
+		scene.erase(blocks[i]);
+	}
+
+	const double unload = microsecondsSince(start);
+
+#ifdef ARCHETYPE
+	SDL_Log("Archetype storage, %d chunks, %d frames, %zu pickups", chunks, frames, picked);
+#else
+	SDL_Log("Sparse set storage, %d chunks, %d frames, %zu pickups", chunks, frames, picked);
+#endif
+	SDL_Log("chunk load (%dx%d)      %9.1f us", CHUNK_WIDTH, CHUNK_HEIGHT, load);
+	SDL_Log("item physics (%d)      %9.1f us/frame", ITEMS, physics);
+	SDL_Log("block instance data     %9.1f us/frame", render);
+	SDL_Log("unload %zu blocks     %9.1f us", blocks.size() / 2, unload);
+}
@@ -0,0 +1,101 @@
+// Physics shaped passes over the moving entities, serially and on 1 up to the given number of threads
+// Usage: bench-thread_pool [entities] [frames] [threads], threads defaults to the cores
+
+#include "components.hpp"
+#include "misc/thread_pool.hpp"
+#include "scene.hpp"
+#include "third_party/Eigen/Core"
+
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr const static int WIDTH = 256;
+constexpr const static int HEIGHT = 128;
+constexpr const static float TILE = 112.0f;
+
+// Solid tiles, only read by the passes like the terrain in `PhysicsSystem::update`
+struct terrain {
+	std::vector<bool> solid;
+
+	[[nodiscard]] bool at(const int x, const int y) const {
+		return x >= 0 && y >= 0 && x < WIDTH && y < HEIGHT && solid[y * WIDTH + x];
+	}
+};
+
+// The ground check and gravity, then the integration, for one entity
+void step(const terrain& ground, Components::position& position, Components::velocity& velocity) {
+	const Eigen::Vector2f min = position.mPosition - Eigen::Vector2f(0.0f, 0.5f);
+	const Eigen::Vector2f max = position.mPosition + Eigen::Vector2f(30.0f, 30.0f);
+
+	bool onGround = false;
+	for (int x = static_cast<int>(min.x() / TILE); x <= static_cast<int>(max.x() / TILE); ++x) {
+		for (int y = static_cast<int>(min.y() / TILE); y <= static_cast<int>(max.y() / TILE); ++y) {
+			onGround = onGround || (ground.at(x, y) && min.y() < (y + 1) * TILE);
+		}
+	}
+
+	velocity.mVelocity.y() = onGround ? 0.0f : velocity.mVelocity.y() - 1200.0f * 0.016f;
+	position.mPosition += velocity.mVelocity * 0.016f;
+	position.mPosition.y() = std::max(position.mPosition.y(), 0.0f);
+	velocity.mVelocity.x() *= 0.7f;
+}
+
+template <typename Func> double millisecondsPerFrame(const int frames, Func&& frame) {
+	frame();
+
+	const auto start = Clock::now();
+	for (int i = 0; i < frames; ++i) {
+		frame();
+	}
+
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+	const int entities = argc > 1 ? std::atoi(argv[1]) : 100000;
+	const int frames = argc > 2 ? std::atoi(argv[2]) : 50;
+	const std::size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+	const std::size_t maxThreads = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : cores;
+
+	std::mt19937 random(3);
+	terrain ground{std::vector<bool>(WIDTH * HEIGHT)};
+	for (int y = 0; y < HEIGHT / 2; ++y) {
+		for (int x = 0; x < WIDTH; ++x) {
+			ground.solid[y * WIDTH + x] = random() % 10 < 7;
+		}
+	}
+
+	Scene scene;
+	for (int i = 0; i < entities; ++i) {
+		const EntityID entity = scene.newEntity();
+		scene.emplace<Components::position>(
+			entity, Eigen::Vector2f(random() % (WIDTH * 112), HEIGHT / 2 * TILE + random() % 1000));
+		scene.emplace<Components::velocity>(entity, Eigen::Vector2f(random() % 100, -50.0f));
+	}
+
+	const auto moving = scene.view<Components::position, Components::velocity>();
+	const auto body = [&ground](Components::position& position, Components::velocity& velocity) {
+		step(ground, position, velocity);
+	};
+
+	const double serial = millisecondsPerFrame(frames, [&] { moving.each(body); });
+	SDL_Log("%d entities, %zu cores", entities, cores);
+	SDL_Log("each:                  %8.3f ms/frame", serial);
+
+	for (std::size_t threads = 1; threads <= maxThreads; ++threads) {
+		utils::thread_pool pool(threads - 1);
+		const double parallel = millisecondsPerFrame(frames, [&] { moving.par_each(body, 256, pool); });
+
+		SDL_Log("par_each, %2zu threads: %8.3f ms/frame, %.2fx", threads, parallel, serial / parallel);
+	}
+}
@@ -13,6 +13,7 @@
 class Texture;
 class Shader;
 class Inventory;
+class Scene;
 
 template <typename T>
 concept isEnum = requires(T e) { std::is_enum_v<T>; };
@@ -23,17 +24,22 @@ constexpr auto etoi(T e) {
 	return static_cast<std::underlying_type_t<T>>(e);
 }
 
+// Plain data components set `PERSISTENT` to be saved in scene snapshots, see `utils::persistent`
 namespace Components {
 struct position {
 	Eigen::Vector2f mPosition;
 
 	position(const decltype(mPosition) pos) noexcept : mPosition(pos) {}
+
+	constexpr const static inline bool PERSISTENT = true;
 };
 
 struct velocity {
 	Eigen::Vector2f mVelocity;
 
 	velocity(const decltype(mVelocity) vel) noexcept : mVelocity(vel) {}
+
+	constexpr const static inline bool PERSISTENT = true;
 };
 
 struct collision {
@@ -45,6 +51,8 @@ struct collision {
 	collision(const decltype(mOffset) offset, const decltype(mSize) size,
 		  const decltype(mStationary) stationary = false) noexcept
 		: mOffset(offset), mSize(size), mStationary(stationary) {}
+
+	constexpr const static inline bool PERSISTENT = true;
 };
 
 struct texture {
@@ -76,17 +84,11 @@ struct text {
 	text(const decltype(mID) id) noexcept : mID(id) {}
 };
 
-// Misc stuff like jumping
-struct misc {
-	enum {
-		JUMP = 0b1,
-		PLAYER = 0b10,
-		CROSSHAIR = 0b100,
-	};
-	std::uint64_t mWhat;
-
-	constexpr misc(const decltype(mWhat) what) noexcept : mWhat(what) {}
-};
+// Tags, the pools only remember who has them
+// `scene->view<Components::position, Components::player>()` walks the players, no per entity flag test
+struct jump {};
+struct player {};
+struct crosshair {};
 
 enum class Item : std::uint64_t;
 
@@ -98,6 +100,7 @@ struct block {
 		: mType(type), mPosition(position) {}
 
 	constexpr const static inline auto BLOCK_SIZE = 112;
+	constexpr const static inline bool PERSISTENT = true;
 };
 
 struct inventory {
@@ -108,5 +111,7 @@ struct inventory {
 
 struct item {
 	Item mType;
+
+	constexpr const static inline bool PERSISTENT = true;
 };
 } // namespace Components
@@ -2,6 +2,7 @@
 
 #include "components.hpp"
 #include "managers/entityManager.hpp"
+#include "managers/eventBus.hpp"
 #include "opengl/shader.hpp"
 #include "screens/screen.hpp"
 #include "systems/renderSystem.hpp"
@@ -70,7 +71,7 @@ class Inventory : public Screen {
 	constexpr const static inline auto ITEMS_KEY = "items";
 	constexpr const static inline auto COUNT_KEY = "count";
 
-	constexpr const static inline auto DOUBLE_CLICK_SIGNAL = "double_click"_u;
+	constexpr const static inline auto DOUBLE_CLICK_EVENT = EventBus::Event::DOUBLE_CLICK;
 
       private:
 	void close();
@@ -1,11 +1,30 @@
 #pragma once
 
 #include <cstdint>
-#include <random>
+#include <span>
 
-// Basic 1D noise
+// Gradient noise for the terrain, caves and ores, and the rolls of the world generation
+// Everything is a pure function of the seed and the position, so any chunk can be generated alone, on any thread,
+// in any order, and always comes out the same
 class NoiseGenerator {
       public:
+	// What a roll or a noise is for, so two features at the same block don't get the same value
+	enum class Feature : std::uint32_t {
+		STRUCTURE,
+		VEIN,
+		VEIN_SIZE,
+		VEIN_STEP,
+		HEIGHT,
+		CAVE,
+		ORE,
+	};
+
+	// The first octave is `period` blocks wide, a power of two, every next one half as wide and half as strong
+	struct octaves {
+		std::uint32_t period;
+		std::uint32_t count;
+	};
+
 	NoiseGenerator();
 	NoiseGenerator(std::uint64_t seed);
 
@@ -15,13 +34,31 @@ class NoiseGenerator {
 	NoiseGenerator& operator=(const NoiseGenerator&) = default;
 	~NoiseGenerator() = default;
 
-	double getNoise(std::int64_t x) const;
-	// Generates a random double between 0.0f and 1.0f
-	float randf();
+	// Perlin noise, about -1 to 1, sampled at whole blocks and evaluated in SIMD lanes where there are any
+	// 1D along the row of `noise.size()` blocks from `x`
+	void getNoise(Feature feature, std::int64_t x, std::span<float> noise, octaves shape) const;
+	// 2D up the column of `noise.size()` blocks from `x` `y`
+	void getNoise(Feature feature, std::int64_t x, std::int64_t y, std::span<float> noise, octaves shape) const;
+	// A float between 0.0f and 1.0f, 1.0f excluded, for the block at `x` `y` in world space
+	// `index` tells the rolls of one feature at the same block apart, like the steps of an ore vein
+	[[nodiscard]] float randf(std::int64_t x, std::int64_t y, Feature feature, std::uint32_t index = 0) const;
+	// The 64 bits `randf` is made from
+	[[nodiscard]] std::uint64_t hash(std::int64_t x, std::int64_t y, Feature feature,
+					 std::uint32_t index = 0) const;
 	std::uint64_t getSeed() const { return mSeed; }
 	void setSeed(std::uint64_t seed) { mSeed = seed; }
 
       private:
+	// The 32 bit seed of one octave of a feature
+	[[nodiscard]] std::uint32_t seedOf(Feature feature, std::uint32_t octave) const;
+
+	// The splitmix64 finalizer, every input bit flips about half of the output bits
+	[[nodiscard]] static constexpr std::uint64_t mix(std::uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+		return z ^ (z >> 31);
+	}
+
 	std::uint64_t mSeed;
-	std::mt19937_64 mRng;
 };
@@ -1,49 +1,359 @@
 #pragma once
 
+#ifdef ARCHETYPE
+#include "misc/archetype.hpp"
+#endif
+#include "misc/signal.hpp"
+#include "misc/snapshot.hpp"
 #include "misc/sparse_set.hpp"
+#include "misc/sparse_set_group.hpp"
+#include "misc/type_id.hpp"
 
+#include <SDL3/SDL.h>
+#include <bit>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
 
 using ComponentID = std::uint64_t;
 constexpr const static ComponentID MAX_COMPONENTS = std::numeric_limits<ComponentID>::max();
 
+class ComponentManager;
+
+// Also the bit of the component in the entity signatures
+template <typename Component> [[nodiscard]] inline ComponentID componentID() noexcept {
+	return utils::type_id<ComponentManager>::value<Component>;
+}
+
+namespace utils {
+// Defined in sparse_set_view.hpp, which needs the manager
+template <typename, typename...> class lazy_view;
+} // namespace utils
+
+// Both storages below have the same interface, the one Scene uses
+// Which one is built is picked with the ARCHETYPE option
+
+#ifdef ARCHETYPE
+// Entities with the same set of components share a table, with one column per component
+// Iterating is a linear walk over the columns, but adding or removing a component moves the entity to another table
 class ComponentManager {
+      public:
 	ComponentManager() = default;
 	ComponentManager(ComponentManager&&) = delete;
 	ComponentManager(const ComponentManager&) = delete;
 	ComponentManager& operator=(ComponentManager&&) = delete;
 	ComponentManager& operator=(const ComponentManager&) = delete;
+	~ComponentManager() {}
+
+	template <typename Component, typename... Args> void emplace(const EntityID entity, Args&&... args) {
+		mStorage.emplace<Component>(entity, std::forward<Args>(args)...);
+	}
+
+	template <typename Component, typename Values>
+	void insert(const std::span<const EntityID> entities, Values&& values) {
+		mStorage.insert<Component>(entities, std::forward<Values>(values));
+	}
+
+	void erase(const EntityID entity) noexcept { mStorage.erase(entity); }
+	// Each entity leaves its own table, there is nothing to share between them
+	void erase(const std::span<const EntityID> entities) noexcept {
+		for (const auto entity : entities) {
+			mStorage.erase(entity);
+		}
+	}
+	void clear() noexcept { mStorage.clear(); }
+
+	template <typename Component> [[nodiscard]] Component& get(const EntityID entity) {
+		return mStorage.get<Component>(entity);
+	}
+
+	template <typename Component> [[nodiscard]] Component& getMut(const EntityID entity) {
+		return mStorage.get_mut<Component>(entity);
+	}
+
+	template <typename Component> [[nodiscard]] bool contains(const EntityID entity) const noexcept {
+		return mStorage.contains<Component>(entity);
+	}
+
+	template <typename Component, typename... Args> Component& replace(const EntityID entity, Args&&... args) {
+		return mStorage.replace<Component>(entity, std::forward<Args>(args)...);
+	}
+
+	template <typename Component, typename Func> Component& patch(const EntityID entity, Func&& func) {
+		return mStorage.patch<Component>(entity, std::forward<Func>(func));
+	}
+
+	template <typename Component> [[nodiscard]] utils::signal<EntityID, Component&>& onConstruct() {
+		return mStorage.on_construct<Component>();
+	}
+
+	template <typename Component> [[nodiscard]] utils::signal<EntityID, Component&>& onDestroy() {
+		return mStorage.on_destroy<Component>();
+	}
+
+	template <typename Component> [[nodiscard]] utils::signal<EntityID, Component&>& onReplace() {
+		return mStorage.on_replace<Component>();
+	}
+
+	template <typename... Components, typename... Excludes>
+	[[nodiscard]] utils::archetype_view<utils::exclude_t<Excludes...>, Components...>
+	view(utils::exclude_t<Excludes...> = {}) {
+		return mStorage.view<Components...>(utils::exclude_t<Excludes...>{});
+	}
 
+	// The tables already keep the components of an entity side by side, so a group is just a view
+	template <typename... Owned> [[nodiscard]] utils::archetype_view<utils::exclude_t<>, Owned...> group() {
+		return mStorage.view<Owned...>();
+	}
+
+	// Bumped every time an entity gets or loses the component
+	template <typename Component> [[nodiscard]] std::uint64_t version() { return mStorage.version<Component>(); }
+
+	[[nodiscard]] std::uint64_t tick() const noexcept { return mStorage.tick(); }
+	std::uint64_t advanceTick() noexcept { return mStorage.advance_tick(); }
+
+	// Snapshots, see `Scene::saveSnapshot`
+	template <typename Component> [[nodiscard]] std::size_t size() const noexcept {
+		return mStorage.size<Component>();
+	}
+
+	template <typename Component> void savePool(utils::snapshot_writer& writer) const {
+		mStorage.save<Component>(writer);
+	}
+
+	template <typename Component>
+	void restorePool(const std::span<const EntityID> entities, const std::byte* const values) {
+		mStorage.restore<Component>(entities, values);
+	}
+
+      private:
+	utils::archetype_storage mStorage;
+};
+#else
+// Owned by a scene, so every scene has its own pools
+class ComponentManager {
       public:
+	ComponentManager() = default;
+	ComponentManager(ComponentManager&&) = delete;
+	ComponentManager(const ComponentManager&) = delete;
+	ComponentManager& operator=(ComponentManager&&) = delete;
+	ComponentManager& operator=(const ComponentManager&) = delete;
 	~ComponentManager() {}
 
-	static ComponentManager* getInstance() {
-		static ComponentManager manager;
-		return &manager;
+	// Indexed by the dense component ID, the pool is created the first time it's needed
+	template <typename Component> [[nodiscard]] utils::sparse_set<Component>* getPool() {
+		const ComponentID id = componentID<Component>();
+
+		if (id >= mPools.size() || !mPools[id]) [[unlikely]] {
+			SDL_assert(id < MAX_COMPONENT_TYPES && "Too many component types for the signatures");
+
+			if (id >= mPools.size()) {
+				mPools.resize(id + 1);
+			}
+
+			mPools[id] = std::make_unique<utils::sparse_set<Component>>();
+			mPools[id]->set_clock(&mTick);
+		}
+
+		return static_cast<utils::sparse_set<Component>*>(mPools[id].get());
 	}
 
-	template <typename Component> [[nodiscard]] utils::sparse_set<Component>* getPool() {
-		static utils::sparse_set<Component> pool = (mPools.emplace_back(&pool), utils::sparse_set<Component>());
+	// Never creates the pool, so it's safe to call from several threads at once
+	template <typename Component> [[nodiscard]] utils::sparse_set<Component>* findPool() const noexcept {
+		const ComponentID id = componentID<Component>();
+
+		return id < mPools.size() ? static_cast<utils::sparse_set<Component>*>(mPools[id].get()) : nullptr;
+	}
+
+	// The group is created the first time it's asked for, and sorts the pools from then on
+	template <typename... Owned> [[nodiscard]] utils::group_handler<Owned...>* getGroup() {
+		const std::size_t id =
+			utils::type_id<utils::group_handler_interface>::value<utils::group_handler<Owned...>>;
+
+		if (id >= mGroups.size()) {
+			mGroups.resize(id + 1);
+		}
 
-		return &pool;
+		if (!mGroups[id]) {
+			mGroups[id] = std::make_unique<utils::group_handler<Owned...>>(getPool<Owned>()...);
+		}
+
+		return static_cast<utils::group_handler<Owned...>*>(mGroups[id].get());
+	}
+
+	template <typename Component, typename... Args> void emplace(const EntityID entity, Args&&... args) {
+		getPool<Component>()->emplace(entity, std::forward<Args>(args)...);
+		signature(entity) |= std::uint64_t(1) << componentID<Component>();
+	}
+
+	template <typename Component, typename Values>
+	void insert(const std::span<const EntityID> entities, Values&& values) {
+		getPool<Component>()->insert(entities, std::forward<Values>(values));
+
+		const std::uint64_t bit = std::uint64_t(1) << componentID<Component>();
+		for (const auto entity : entities) {
+			signature(entity) |= bit;
+		}
 	}
 
+	// Only visits the pools the entity is in
 	void erase(const EntityID entity) noexcept {
-		for (auto* pool : mPools) {
-			if (pool->contains(entity)) {
-				pool->erase(entity);
+		if (entityIndex(entity) >= mSignatures.size()) {
+			return;
+		}
+
+		for (std::uint64_t bits = mSignatures[entityIndex(entity)]; bits != 0; bits &= bits - 1) {
+			mPools[std::countr_zero(bits)]->erase(entity);
+		}
+
+		mSignatures[entityIndex(entity)] = 0;
+	}
+
+	// Pool by pool rather than entity by entity, each pool is only visited once
+	void erase(const std::span<const EntityID> entities) noexcept {
+		std::uint64_t used = 0;
+		for (const auto entity : entities) {
+			if (entityIndex(entity) < mSignatures.size()) {
+				used |= mSignatures[entityIndex(entity)];
+			}
+		}
+
+		for (std::uint64_t bits = used; bits != 0; bits &= bits - 1) {
+			const std::uint64_t bit = bits & -bits;
+			auto& pool = *mPools[std::countr_zero(bits)];
+
+			for (const auto entity : entities) {
+				// Cleared as it goes, so an entity listed twice is only erased once
+				if (entityIndex(entity) < mSignatures.size() && (mSignatures[entityIndex(entity)] & bit) != 0) {
+					pool.erase(entity);
+					mSignatures[entityIndex(entity)] &= ~bit;
+				}
 			}
 		}
 	}
 
 	void clear() noexcept {
-		for (auto* pool : mPools) {
-			pool->clear();
+		for (auto& pool : mPools) {
+			if (pool) {
+				pool->clear();
+			}
+		}
+
+		mSignatures.clear();
+	}
+
+	template <typename Component> [[nodiscard]] Component& get(const EntityID entity) {
+		return getPool<Component>()->get(entity);
+	}
+
+	template <typename Component> [[nodiscard]] Component& getMut(const EntityID entity) {
+		return getPool<Component>()->get_mut(entity);
+	}
+
+	template <typename Component> [[nodiscard]] bool contains(const EntityID entity) const noexcept {
+		const auto* const pool = findPool<Component>();
+
+		return pool != nullptr && pool->contains(entity);
+	}
+
+	template <typename Component, typename... Args> Component& replace(const EntityID entity, Args&&... args) {
+		return getPool<Component>()->replace(entity, std::forward<Args>(args)...);
+	}
+
+	template <typename Component, typename Func> Component& patch(const EntityID entity, Func&& func) {
+		return getPool<Component>()->patch(entity, std::forward<Func>(func));
+	}
+
+	template <typename Component> [[nodiscard]] utils::signal<EntityID, Component&>& onConstruct() {
+		return getPool<Component>()->on_construct();
+	}
+
+	template <typename Component> [[nodiscard]] utils::signal<EntityID, Component&>& onDestroy() {
+		return getPool<Component>()->on_destroy();
+	}
+
+	template <typename Component> [[nodiscard]] utils::signal<EntityID, Component&>& onReplace() {
+		return getPool<Component>()->on_replace();
+	}
+
+	template <typename... Components, typename... Excludes>
+	[[nodiscard]] utils::lazy_view<utils::exclude_t<Excludes...>, Components...>
+	view(utils::exclude_t<Excludes...> = {}) {
+		return utils::lazy_view<utils::exclude_t<Excludes...>, Components...>(
+			std::make_tuple(getPool<Components>()...), std::make_tuple(getPool<Excludes>()...));
+	}
+
+	template <typename... Owned> [[nodiscard]] utils::group<Owned...> group() {
+		return utils::group<Owned...>(getGroup<Owned...>());
+	}
+
+	// Bumped every time an entity gets or loses the component
+	template <typename Component> [[nodiscard]] std::uint64_t version() { return getPool<Component>()->version(); }
+
+	// Stamped on the components added or changed from now on
+	[[nodiscard]] std::uint64_t tick() const noexcept { return mTick; }
+
+	// Returns the current tick and starts a new one, so what's changed after the call is newer than the returned
+	// tick
+	std::uint64_t advanceTick() noexcept { return mTick++; }
+
+	// Snapshots, see `Scene::saveSnapshot`
+	template <typename Component> [[nodiscard]] std::size_t size() const noexcept {
+		const auto* const pool = findPool<Component>();
+
+		return pool == nullptr ? 0 : pool->size();
+	}
+
+	// The packed entities, and then the packed components
+	template <typename Component> void savePool(utils::snapshot_writer& writer) const {
+		auto* const pool = findPool<Component>();
+		if (pool == nullptr) {
+			return;
+		}
+
+		writer.bytes(pool->data(), pool->size() * sizeof(EntityID));
+		if constexpr (!utils::sparse_set<Component>::TAG) {
+			writer.bytes(pool->raw(), pool->size() * sizeof(Component));
+		}
+	}
+
+	// Replaces the pool, see `utils::sparse_set::restore`
+	template <typename Component>
+	void restorePool(const std::span<const EntityID> entities, const std::byte* const values) {
+		getPool<Component>()->restore(entities, values);
+
+		// The entities that were in the pool before lost the component
+		const std::uint64_t bit = std::uint64_t(1) << componentID<Component>();
+		for (auto& bits : mSignatures) {
+			bits &= ~bit;
+		}
+
+		for (const auto entity : entities) {
+			signature(entity) |= bit;
 		}
 	}
 
       private:
-	std::vector<utils::sparse_set_interface*> mPools;
+	[[nodiscard]] std::uint64_t& signature(const EntityID entity) {
+		if (entityIndex(entity) >= mSignatures.size()) {
+			mSignatures.resize(entityIndex(entity) + 1);
+		}
+
+		return mSignatures[entityIndex(entity)];
+	}
+
+	// Null for the component types this scene never used
+	std::vector<std::unique_ptr<utils::sparse_set_interface>> mPools;
+	// Declared after the pools so they are destroyed first, they still point into the pools
+	std::vector<std::unique_ptr<utils::group_handler_interface>> mGroups;
+	// Index is the entity index, a set bit means the entity is in the pool with that ID
+	std::vector<std::uint64_t> mSignatures;
+	// Starts above 0, so everything is newer than a system that never ran
+	std::uint64_t mTick = 1;
 };
+#endif
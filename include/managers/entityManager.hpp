@@ -4,11 +4,34 @@
 #include <cstdint>
 #include <deque>
 #include <limits>
+#include <vector>
 
+// An entity is a handle: the low bits are the index into the dense tables, the high bits are the generation of
+// that index. Releasing an entity bumps the generation of its index, so stale handles never alias a new entity
 using EntityID = std::uint64_t;
 
-constexpr const static EntityID MAX_ENTITIES = std::numeric_limits<EntityID>::max();
+constexpr const static EntityID MAX_ENTITIES = std::numeric_limits<std::uint32_t>::max();
 constexpr const static std::uint64_t MAX_COMPONENT_TYPES = 64;
+constexpr const static std::uint64_t ENTITY_INDEX_BITS = 32;
+constexpr const static EntityID ENTITY_INDEX_MASK = (EntityID(1) << ENTITY_INDEX_BITS) - 1;
+
+[[nodiscard]] constexpr inline std::uint32_t entityIndex(const EntityID entity) noexcept {
+	return static_cast<std::uint32_t>(entity & ENTITY_INDEX_MASK);
+}
+
+[[nodiscard]] constexpr inline std::uint32_t entityGeneration(const EntityID entity) noexcept {
+	return static_cast<std::uint32_t>(entity >> ENTITY_INDEX_BITS);
+}
+
+[[nodiscard]] constexpr inline EntityID makeEntity(const std::uint32_t index,
+						   const std::uint32_t generation) noexcept {
+	return (static_cast<EntityID>(generation) << ENTITY_INDEX_BITS) | index;
+}
+
+namespace utils {
+class snapshot_reader;
+class snapshot_writer;
+} // namespace utils
 
 class EntityManager {
       public:
@@ -20,11 +43,20 @@ class EntityManager {
 	~EntityManager() = default;
 
 	[[nodiscard]] EntityID getEntity();
+	// Appends `count` new entities to `entities`
+	void getEntities(std::size_t count, std::vector<EntityID>& entities);
 	void releaseEntity(EntityID entity);
-	[[nodiscard]] std::size_t getEntityCount() const { return mNext - mReleased.size(); }
+	[[nodiscard]] std::size_t getEntityCount() const { return mGenerations.size() - 1 - mReleased.size(); }
 	[[nodiscard]] bool valid(const EntityID entity) const;
 
+	// The generations and the released indices, so the same handles are valid after a restore
+	void save(utils::snapshot_writer& writer) const;
+	// False if the data is broken, the manager is then left as new
+	[[nodiscard]] bool restore(utils::snapshot_reader& reader);
+
       private:
-	EntityID mNext;
-	std::deque<EntityID> mReleased;
+	// Index is the entity index, value is the current generation of that index
+	// Index 0 is never handed out, so entity 0 stays the null entity
+	std::vector<std::uint32_t> mGenerations;
+	std::deque<std::uint32_t> mReleased;
 };
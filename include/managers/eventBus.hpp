@@ -0,0 +1,88 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The input state of a scene, filled by the EventManager and read by the systems
+// Three kinds of state, each stored the way it's queried:
+// - keys, a flag per scancode
+// - signals, a fixed slot per well-known value that lasts across frames, like when a button started being held
+// - events, things that happened this frame, like a click. They are dropped by `endFrame`
+class EventBus {
+      public:
+	enum class Signal : std::uint8_t {
+		LEFT_HOLD,
+		RIGHT_HOLD,
+		PHYSICS_DIRTY,
+		COLLISION_EDITOR,
+
+		COUNT,
+	};
+
+	enum class Event : std::uint8_t {
+		LEFT_CLICK,
+		RIGHT_CLICK,
+		DOUBLE_CLICK,
+	};
+
+	using signal_table = std::array<std::int64_t, static_cast<std::size_t>(Signal::COUNT)>;
+
+	explicit EventBus() noexcept : mKeys(), mSignals(), mEvents() {}
+	EventBus(EventBus&&) = delete;
+	EventBus(const EventBus&) = delete;
+	EventBus& operator=(EventBus&&) = delete;
+	EventBus& operator=(const EventBus&) = delete;
+	~EventBus() = default;
+
+	[[nodiscard]] bool pressed(const SDL_Scancode key) const noexcept { return mKeys[key]; }
+	void press(const SDL_Scancode key) noexcept { mKeys[key] = true; }
+	// Also used to take a key press, so it's only acted on once
+	void release(const SDL_Scancode key) noexcept { mKeys[key] = false; }
+
+	[[nodiscard]] std::int64_t& signal(const Signal signal) noexcept {
+		return mSignals[static_cast<std::size_t>(signal)];
+	}
+
+	void push(const Event type, const std::uint64_t time) { mEvents.emplace_back(event{type, time, false}); }
+
+	// When the first event of that type not consumed yet happened, 0 if there is none
+	[[nodiscard]] std::uint64_t peek(const Event type) const noexcept {
+		for (const auto& queued : mEvents) {
+			if (queued.type == type && !queued.consumed) {
+				return queued.time;
+			}
+		}
+
+		return 0;
+	}
+
+	// Takes the events of that type, so the systems after don't act on them again
+	void consume(const Event type) noexcept {
+		for (auto& queued : mEvents) {
+			queued.consumed |= queued.type == type;
+		}
+	}
+
+	// Called once the frame is over
+	void endFrame() noexcept { mEvents.clear(); }
+
+#ifdef IMGUI
+	// For the signal list in the developer menu
+	[[nodiscard]] const signal_table& signals() const noexcept { return mSignals; }
+#endif
+
+      private:
+	struct event {
+		Event type;
+		std::uint64_t time;
+		bool consumed;
+	};
+
+	std::array<bool, SDL_SCANCODE_COUNT> mKeys;
+	signal_table mSignals;
+	// Only a handful per frame, and the capacity is kept
+	std::vector<event> mEvents;
+};
@@ -3,14 +3,16 @@
 #include <SDL3/SDL.h>
 #include <cstddef>
 
-#include "opengl/shader.hpp"
+#include "managers/eventBus.hpp"
 
 class EventManager {
       public:
-	constexpr const static inline auto LEFT_CLICK_DOWN_SIGNAL = "left_click"_u;
-	constexpr const static inline auto LEFT_HOLD_SIGNAL = "left_hold"_u;
-	constexpr const static inline auto RIGHT_CLICK_DOWN_SIGNAL = "right_click"_u;
-	constexpr const static inline auto RIGHT_HOLD_SIGNAL = "right_hold"_u;
+	// Stamped with the time of the click
+	constexpr const static inline auto LEFT_CLICK_EVENT = EventBus::Event::LEFT_CLICK;
+	constexpr const static inline auto RIGHT_CLICK_EVENT = EventBus::Event::RIGHT_CLICK;
+	// The time the button started being held, 0 when it isn't
+	constexpr const static inline auto LEFT_HOLD_SIGNAL = EventBus::Signal::LEFT_HOLD;
+	constexpr const static inline auto RIGHT_HOLD_SIGNAL = EventBus::Signal::RIGHT_HOLD;
 
 	explicit EventManager() noexcept;
 	EventManager(EventManager&&) = delete;
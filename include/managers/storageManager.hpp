@@ -15,6 +15,9 @@ class StorageManager {
 	[[nodiscard]] bool restore();
 	void save();
 
+	// The directory the region files of the world go in, with a trailing separator
+	[[nodiscard]] static std::string getRegionPath();
+
       private:
 	[[nodiscard]] bool restoreState(struct SDL_Storage* storage);
 	[[nodiscard]] bool loadWorld(struct SDL_Storage* storage, const std::string& world);
@@ -23,6 +26,8 @@ class StorageManager {
 
 	constexpr const static inline unsigned long long LATEST_LEVEL_VERSION = 100;
 	constexpr const static inline unsigned long long LATEST_WORLD_VERSION = 100;
+	// FIXME: Non-hard writted world name, ask for user input
+	constexpr const static inline char* WORLD_NAME = "world";
 
 	class Game* const mGame;
 };
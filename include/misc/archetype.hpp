@@ -0,0 +1,808 @@
+#pragma once
+
+#include "managers/entityManager.hpp"
+#include "misc/signal.hpp"
+#include "misc/snapshot.hpp"
+#include "misc/sparse_set.hpp"
+#include "misc/thread_pool.hpp"
+#include "misc/type_id.hpp"
+
+#include <SDL3/SDL.h>
+#include <array>
+#include <bit>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+// One component type of one table, rows line up with the entities of the table
+class archetype_column_interface {
+      public:
+	virtual ~archetype_column_interface() = default;
+
+	// Appends row `row` of `other`, a column of the same type, the row is left moved from
+	virtual void push_from(archetype_column_interface& other, const std::size_t row) = 0;
+	// Moves the last row into `row`, and drops the last row
+	virtual void swap_remove(const std::size_t row) = 0;
+	virtual void reserve(const std::size_t capacity) = 0;
+	virtual void clear() noexcept = 0;
+	// Tells the destroy listeners, before the row goes
+	virtual void destroying(const EntityID entity, const std::size_t row) = 0;
+	// An empty column of the same type, for a new table
+	[[nodiscard]] virtual std::unique_ptr<archetype_column_interface> make() const = 0;
+
+	[[nodiscard]] component_ticks& ticks(const std::size_t row) noexcept { return mTicks[row]; }
+	[[nodiscard]] const component_ticks& ticks(const std::size_t row) const noexcept { return mTicks[row]; }
+
+      protected:
+	std::vector<component_ticks> mTicks;
+};
+
+struct archetype_component_interface {
+	virtual ~archetype_component_interface() = default;
+
+	// Bumped every time an entity gets or loses the component
+	std::uint64_t version = 0;
+};
+
+// What's shared by all the columns of a component type
+template <typename Component> struct archetype_component final : archetype_component_interface {
+	signal<EntityID, Component&> onConstruct;
+	signal<EntityID, Component&> onDestroy;
+	signal<EntityID, Component&> onReplace;
+};
+
+// Like `sparse_set`, empty types are tags and have no values, `at` hands out a shared instance
+template <typename Component> class archetype_column final : public archetype_column_interface {
+      public:
+	constexpr const static inline bool TAG = std::is_empty_v<Component>;
+
+	explicit archetype_column(archetype_component<Component>* const component) noexcept : mComponent(component) {}
+
+	template <typename... Args> void push(const std::uint64_t tick, Args&&... args) {
+		mTicks.emplace_back(tick, tick);
+
+		if constexpr (!TAG) {
+			mValues.emplace_back(std::forward<Args>(args)...);
+		}
+	}
+
+	void push_from(archetype_column_interface& other, const std::size_t row) override {
+		auto& column = static_cast<archetype_column&>(other);
+		mTicks.emplace_back(column.mTicks[row]);
+
+		if constexpr (!TAG) {
+			mValues.emplace_back(std::move(column.mValues[row]));
+		}
+	}
+
+	void swap_remove(const std::size_t row) override {
+		mTicks[row] = mTicks.back();
+		mTicks.pop_back();
+
+		if constexpr (!TAG) {
+			if (row + 1 != mValues.size()) {
+				mValues[row] = std::move(mValues.back());
+			}
+
+			mValues.pop_back();
+		}
+	}
+
+	void reserve(const std::size_t capacity) override {
+		mTicks.reserve(capacity);
+
+		if constexpr (!TAG) {
+			mValues.reserve(capacity);
+		}
+	}
+
+	void clear() noexcept override {
+		mTicks.clear();
+
+		if constexpr (!TAG) {
+			mValues.clear();
+		}
+	}
+
+	void destroying(const EntityID entity, const std::size_t row) override {
+		if (!mComponent->onDestroy.empty()) {
+			mComponent->onDestroy.publish(entity, at(row));
+		}
+	}
+
+	[[nodiscard]] std::unique_ptr<archetype_column_interface> make() const override {
+		return std::make_unique<archetype_column>(mComponent);
+	}
+
+	[[nodiscard]] Component& at(const std::size_t row) noexcept {
+		if constexpr (TAG) {
+			return sTag;
+		} else {
+			return mValues[row];
+		}
+	}
+
+	[[nodiscard]] archetype_component<Component>* component() const noexcept { return mComponent; }
+
+	[[nodiscard]] std::size_t size() const noexcept { return mTicks.size(); }
+
+	// The values, in the same order as the entities of the table
+	[[nodiscard]] const Component* data() const noexcept
+		requires(!TAG)
+	{
+		return mValues.data();
+	}
+
+      private:
+	[[no_unique_address]] std::conditional_t<TAG, std::tuple<>, std::vector<Component>> mValues;
+	archetype_component<Component>* mComponent;
+	static inline Component sTag{};
+};
+
+// All the entities with exactly the components in `signature`
+struct archetype_table final {
+	explicit archetype_table(const std::uint64_t bits) noexcept : signature(bits), columns(), edges() {
+		edges.fill(NO_TABLE);
+	}
+
+	constexpr const static inline std::uint32_t NO_TABLE = std::numeric_limits<std::uint32_t>::max();
+
+	std::uint64_t signature;
+	std::vector<EntityID> entities;
+	// Indexed by component ID, null for the components the table doesn't have
+	std::array<std::unique_ptr<archetype_column_interface>, MAX_COMPONENT_TYPES> columns;
+	// The table an entity goes to when it gets the component, filled the first time
+	std::array<std::uint32_t, MAX_COMPONENT_TYPES> edges;
+};
+
+template <typename, typename...> class archetype_view;
+
+class archetype_storage {
+	struct location {
+		std::uint32_t table;
+		std::uint32_t row;
+	};
+
+      public:
+	// Dense, and also the bit of the component in the table signatures
+	template <typename Component> [[nodiscard]] static std::size_t id() noexcept {
+		return type_id<archetype_storage>::value<Component>;
+	}
+
+	archetype_storage() = default;
+	archetype_storage(archetype_storage&&) = delete;
+	archetype_storage(const archetype_storage&) = delete;
+	archetype_storage& operator=(archetype_storage&&) = delete;
+	archetype_storage& operator=(const archetype_storage&) = delete;
+	~archetype_storage() = default;
+
+	// Moves the entity to the table with the component added, the references to its components are invalidated
+	template <typename Component, typename... Args> void emplace(const EntityID entity, Args&&... args) {
+		const std::size_t bit = id<Component>();
+		archetype_component<Component>* const shared = component<Component>();
+		const location* const from = find(entity);
+
+		if (from != nullptr && (mTables[from->table]->signature >> bit & 1)) {
+			SDL_Log("\033[93mArchetype.hpp: Entity %" PRIu64 " already has this component!\033[0m", entity);
+			Component& value = column<Component>(*mTables[from->table])->at(from->row);
+			value = Component(std::forward<Args>(args)...);
+
+			return;
+		}
+
+		const std::uint32_t target = from == nullptr ? table(std::uint64_t(1) << bit) : edge(from->table, bit);
+		const std::uint32_t row = move(entity, target);
+
+		auto* const added = column<Component>(*mTables[target]);
+		added->push(mTick, std::forward<Args>(args)...);
+
+		++shared->version;
+		if (!shared->onConstruct.empty()) {
+			shared->onConstruct.publish(entity, added->at(row));
+		}
+	}
+
+	// Adds the n-th value to the n-th entity
+	template <typename Component, typename Values>
+	void insert(const std::span<const EntityID> entities, Values&& values) {
+		SDL_assert(std::size(values) == entities.size() && "Every entity needs a component");
+
+		auto value = std::begin(values);
+		for (const auto entity : entities) {
+			if constexpr (std::is_rvalue_reference_v<Values&&>) {
+				emplace<Component>(entity, std::move(*value));
+			} else {
+				emplace<Component>(entity, *value);
+			}
+
+			++value;
+		}
+	}
+
+	void erase(const EntityID entity) noexcept {
+		const location* const at = find(entity);
+		if (at == nullptr) {
+			return;
+		}
+
+		const location from = *at;
+		archetype_table& table = *mTables[from.table];
+
+		for (std::uint64_t bits = table.signature; bits != 0; bits &= bits - 1) {
+			table.columns[std::countr_zero(bits)]->destroying(entity, from.row);
+			++mComponents[std::countr_zero(bits)]->version;
+		}
+
+		remove(from.table, from.row);
+		mLocations[entityIndex(entity)].table = archetype_table::NO_TABLE;
+	}
+
+	void clear() noexcept {
+		for (auto& table : mTables) {
+			for (std::size_t row = table->entities.size(); row != 0; --row) {
+				const EntityID entity = table->entities[row - 1];
+				for (std::uint64_t bits = table->signature; bits != 0; bits &= bits - 1) {
+					table->columns[std::countr_zero(bits)]->destroying(entity, row - 1);
+				}
+			}
+
+			for (std::uint64_t bits = table->signature; bits != 0; bits &= bits - 1) {
+				table->columns[std::countr_zero(bits)]->clear();
+				++mComponents[std::countr_zero(bits)]->version;
+			}
+
+			table->entities.clear();
+		}
+
+		mLocations.clear();
+	}
+
+	template <typename Component> [[nodiscard]] Component& get(const EntityID entity) noexcept {
+		SDL_assert(contains<Component>(entity) && "Hey! This entity doesn't have this component");
+
+		const location& at = mLocations[entityIndex(entity)];
+
+		return column<Component>(*mTables[at.table])->at(at.row);
+	}
+
+	template <typename Component> [[nodiscard]] Component& get_mut(const EntityID entity) noexcept {
+		SDL_assert(contains<Component>(entity) && "Hey! This entity doesn't have this component");
+
+		const location& at = mLocations[entityIndex(entity)];
+		auto* const values = column<Component>(*mTables[at.table]);
+		values->ticks(at.row).changed = mTick;
+
+		return values->at(at.row);
+	}
+
+	// Never creates anything, so it's safe to call from several threads at once
+	template <typename Component> [[nodiscard]] bool contains(const EntityID entity) const noexcept {
+		const location* const at = find(entity);
+
+		return at != nullptr && (mTables[at->table]->signature >> id<Component>() & 1);
+	}
+
+	template <typename Component, typename... Args> Component& replace(const EntityID entity, Args&&... args) {
+		Component& value = get_mut<Component>(entity);
+		value = Component(std::forward<Args>(args)...);
+		component<Component>()->onReplace.publish(entity, value);
+
+		return value;
+	}
+
+	template <typename Component, typename Func> Component& patch(const EntityID entity, Func&& func) {
+		Component& value = get_mut<Component>(entity);
+		std::forward<Func>(func)(value);
+		component<Component>()->onReplace.publish(entity, value);
+
+		return value;
+	}
+
+	template <typename Component> [[nodiscard]] signal<EntityID, Component&>& on_construct() {
+		return component<Component>()->onConstruct;
+	}
+
+	template <typename Component> [[nodiscard]] signal<EntityID, Component&>& on_destroy() {
+		return component<Component>()->onDestroy;
+	}
+
+	template <typename Component> [[nodiscard]] signal<EntityID, Component&>& on_replace() {
+		return component<Component>()->onReplace;
+	}
+
+	// Number of entities with the component
+	template <typename Component> [[nodiscard]] std::size_t size() const noexcept {
+		std::size_t size = 0;
+		for (const auto& table : mTables) {
+			size += (table->signature >> id<Component>() & 1) ? table->entities.size() : 0;
+		}
+
+		return size;
+	}
+
+	// Writes the entities with the component, and then their components, one table after the other
+	template <typename Component>
+		requires persistent<Component>
+	void save(snapshot_writer& writer) const {
+		for (const auto& table : mTables) {
+			if (table->signature >> id<Component>() & 1) {
+				writer.bytes(table->entities.data(), table->entities.size() * sizeof(EntityID));
+			}
+		}
+
+		if constexpr (!std::is_empty_v<Component>) {
+			for (const auto& table : mTables) {
+				if (table->signature >> id<Component>() & 1) {
+					writer.bytes(column<Component>(*table)->data(),
+						     table->entities.size() * sizeof(Component));
+				}
+			}
+		}
+	}
+
+	// Reads back what `save` wrote, the entities move from table to table as they get their components
+	template <typename Component>
+		requires persistent<Component>
+	void restore(const std::span<const EntityID> entities, const std::byte* const values) {
+		for (std::size_t i = 0; i < entities.size(); ++i) {
+			if constexpr (std::is_empty_v<Component>) {
+				emplace<Component>(entities[i]);
+			} else {
+				// The bytes may not be aligned, so each component is copied out first
+				alignas(Component) std::byte value[sizeof(Component)];
+				std::memcpy(value, values + i * sizeof(Component), sizeof(Component));
+				emplace<Component>(entities[i], *std::launder(reinterpret_cast<Component*>(value)));
+			}
+		}
+	}
+
+	template <typename... Components, typename... Excludes>
+	[[nodiscard]] archetype_view<exclude_t<Excludes...>, Components...> view(exclude_t<Excludes...> = {}) {
+		(component<Components>(), ...);
+
+		return archetype_view<exclude_t<Excludes...>, Components...>(this);
+	}
+
+	template <typename Component> [[nodiscard]] std::uint64_t version() {
+		return component<Component>()->version;
+	}
+
+	[[nodiscard]] std::uint64_t tick() const noexcept { return mTick; }
+	std::uint64_t advance_tick() noexcept { return mTick++; }
+
+	[[nodiscard]] const std::vector<std::unique_ptr<archetype_table>>& tables() const noexcept { return mTables; }
+
+	// The column of the component in the table, the table must have it
+	template <typename Component>
+	[[nodiscard]] static archetype_column<Component>* column(const archetype_table& table) noexcept {
+		return static_cast<archetype_column<Component>*>(table.columns[id<Component>()].get());
+	}
+
+	// The table and row of the entity, or a null table
+	[[nodiscard]] std::pair<const archetype_table*, std::size_t> where(const EntityID entity) const noexcept {
+		const location* const at = find(entity);
+		if (at == nullptr) {
+			return {nullptr, 0};
+		}
+
+		return {mTables[at->table].get(), at->row};
+	}
+
+      private:
+	// Also makes sure the component has its shared data and an empty column to copy from
+	template <typename Component> archetype_component<Component>* component() {
+		const std::size_t bit = id<Component>();
+		SDL_assert(bit < MAX_COMPONENT_TYPES && "Too many component types for the signatures");
+
+		if (bit >= mComponents.size()) {
+			mComponents.resize(bit + 1);
+			mPrototypes.resize(bit + 1);
+		}
+
+		if (!mComponents[bit]) {
+			auto shared = std::make_unique<archetype_component<Component>>();
+			mPrototypes[bit] = std::make_unique<archetype_column<Component>>(shared.get());
+			mComponents[bit] = std::move(shared);
+		}
+
+		return static_cast<archetype_component<Component>*>(mComponents[bit].get());
+	}
+
+	[[nodiscard]] const location* find(const EntityID entity) const noexcept {
+		if (entityIndex(entity) >= mLocations.size()) {
+			return nullptr;
+		}
+
+		const location& at = mLocations[entityIndex(entity)];
+		if (at.table == archetype_table::NO_TABLE || mTables[at.table]->entities[at.row] != entity) {
+			return nullptr;
+		}
+
+		return &at;
+	}
+
+	// The table with exactly these components, made if needed
+	[[nodiscard]] std::uint32_t table(const std::uint64_t signature) {
+		if (const auto it = mTableIndex.find(signature); it != mTableIndex.end()) {
+			return it->second;
+		}
+
+		auto table = std::make_unique<archetype_table>(signature);
+		for (std::uint64_t bits = signature; bits != 0; bits &= bits - 1) {
+			table->columns[std::countr_zero(bits)] = mPrototypes[std::countr_zero(bits)]->make();
+		}
+
+		const auto index = static_cast<std::uint32_t>(mTables.size());
+		mTables.emplace_back(std::move(table));
+		mTableIndex.emplace(signature, index);
+
+		return index;
+	}
+
+	[[nodiscard]] std::uint32_t edge(const std::uint32_t from, const std::size_t bit) {
+		if (mTables[from]->edges[bit] == archetype_table::NO_TABLE) {
+			const std::uint32_t to = table(mTables[from]->signature | std::uint64_t(1) << bit);
+			mTables[from]->edges[bit] = to;
+		}
+
+		return mTables[from]->edges[bit];
+	}
+
+	// Appends the entity to `target` with the components it already has, the new component is pushed by the caller
+	std::uint32_t move(const EntityID entity, const std::uint32_t target) {
+		archetype_table& to = *mTables[target];
+		const auto row = static_cast<std::uint32_t>(to.entities.size());
+
+		if (const location* const at = find(entity)) {
+			const location from = *at;
+			archetype_table& table = *mTables[from.table];
+
+			for (std::uint64_t bits = table.signature; bits != 0; bits &= bits - 1) {
+				to.columns[std::countr_zero(bits)]->push_from(*table.columns[std::countr_zero(bits)],
+									     from.row);
+			}
+
+			remove(from.table, from.row);
+		}
+
+		to.entities.emplace_back(entity);
+
+		if (entityIndex(entity) >= mLocations.size()) {
+			mLocations.resize(entityIndex(entity) + 1, location{archetype_table::NO_TABLE, 0});
+		}
+		mLocations[entityIndex(entity)] = location{target, row};
+
+		return row;
+	}
+
+	// The last row takes the place of the removed one
+	void remove(const std::uint32_t index, const std::uint32_t row) {
+		archetype_table& table = *mTables[index];
+
+		for (std::uint64_t bits = table.signature; bits != 0; bits &= bits - 1) {
+			table.columns[std::countr_zero(bits)]->swap_remove(row);
+		}
+
+		table.entities[row] = table.entities.back();
+		table.entities.pop_back();
+
+		if (row != table.entities.size()) {
+			mLocations[entityIndex(table.entities[row])].row = row;
+		}
+	}
+
+	// Tables are never destroyed, so their indices stay valid
+	std::vector<std::unique_ptr<archetype_table>> mTables;
+	std::unordered_map<std::uint64_t, std::uint32_t> mTableIndex;
+	// Index is the entity index
+	std::vector<location> mLocations;
+
+	// Index is the component ID, `archetype_component<Component>`
+	std::vector<std::unique_ptr<archetype_component_interface>> mComponents;
+	std::vector<std::unique_ptr<archetype_column_interface>> mPrototypes;
+
+	std::uint64_t mTick = 1;
+};
+
+// Walks the matching tables backwards, and their rows backwards
+// Like `lazy_view`, the current entity may be erased and new entities may be created while iterating, but an entity
+// that gets or loses a component moves to another table: do that through the deferred commands
+template <typename View> class archetype_view_iterator final {
+      public:
+	// Positions are a table and a row, both one past the element, the iteration stops at `stop`
+	archetype_view_iterator(const View& view, const std::size_t table, const std::size_t row,
+				const std::size_t stopTable, const std::size_t stopRow) noexcept
+		: mView(view), mTable(table), mRow(row), mStopTable(stopTable), mStopRow(stopRow) {
+		skip();
+	}
+
+	archetype_view_iterator& operator++() noexcept { return --mRow, skip(), *this; }
+
+	[[nodiscard]] EntityID operator*() const noexcept { return table().entities[mRow - 1]; }
+
+	[[nodiscard]] const archetype_table& table() const noexcept { return *mView.storage()->tables()[mTable - 1]; }
+	[[nodiscard]] std::size_t row() const noexcept { return mRow - 1; }
+
+	[[nodiscard]] bool operator==(const archetype_view_iterator& other) const noexcept {
+		return mTable == other.mTable && mRow == other.mRow;
+	}
+
+      private:
+	[[nodiscard]] bool stopped() const noexcept { return mTable == mStopTable && mRow <= mStopRow; }
+
+	void skip() noexcept {
+		while (!stopped()) {
+			if (mRow == 0 || !mView.matches(table())) {
+				// Running out of rows in the stop table means we're done
+				if (mTable == mStopTable) {
+					mRow = mStopRow;
+				} else {
+					--mTable;
+					mRow = mTable == 0 ? 0 : table().entities.size();
+				}
+
+				continue;
+			}
+
+			// The current entity may have been erased, and the table shrunk
+			mRow = mRow > table().entities.size() ? table().entities.size() : mRow;
+			if (stopped()) {
+				mRow = mStopRow;
+
+				return;
+			}
+
+			if (mView.accepts(table(), mRow - 1)) {
+				return;
+			}
+
+			--mRow;
+		}
+	}
+
+	View mView;
+	std::size_t mTable;
+	std::size_t mRow;
+	std::size_t mStopTable;
+	std::size_t mStopRow;
+};
+
+template <typename View> class archetype_view_tuple_iterator final {
+      public:
+	explicit archetype_view_tuple_iterator(archetype_view_iterator<View> it) noexcept : mIt(it) {}
+
+	archetype_view_tuple_iterator& operator++() noexcept { return ++mIt, *this; }
+
+	[[nodiscard]] decltype(auto) operator*() const noexcept { return View::tuple_at(mIt.table(), mIt.row()); }
+
+	[[nodiscard]] bool operator==(const archetype_view_tuple_iterator& other) const noexcept {
+		return mIt == other.mIt;
+	}
+
+      private:
+	archetype_view_iterator<View> mIt;
+};
+
+// Same interface as `lazy_view`, so the systems don't care which storage is built
+template <typename... Excludes, typename... ComponentTypes>
+class archetype_view<exclude_t<Excludes...>, ComponentTypes...> {
+	static_assert(sizeof...(ComponentTypes) > 0, "A view needs at least one component");
+
+      public:
+	using iterator = archetype_view_iterator<archetype_view>;
+	using tuple_iterator = archetype_view_tuple_iterator<archetype_view>;
+	using iterable = iterable_adaptor<tuple_iterator>;
+
+	explicit archetype_view(archetype_storage* storage) noexcept
+		: mStorage(storage), mInclude((0 | ... | bit<ComponentTypes>())), mExclude((0 | ... | bit<Excludes>())),
+		  mChanged(0), mAdded(0), mChangedSince(0), mAddedSince(0) {}
+
+	[[nodiscard]] iterator begin() const noexcept {
+		const auto& tables = mStorage->tables();
+
+		return iterator{*this, tables.size(), tables.empty() ? 0 : tables.back()->entities.size(), 0, 0};
+	}
+	[[nodiscard]] iterator cbegin() const noexcept { return begin(); }
+
+	[[nodiscard]] iterator end() const noexcept { return iterator{*this, 0, 0, 0, 0}; }
+	[[nodiscard]] iterator cend() const noexcept { return end(); }
+
+	[[nodiscard]] iterable each() const noexcept {
+		return iterable{tuple_iterator{begin()}, tuple_iterator{end()}};
+	}
+
+	// The fast path, a plain loop over the columns of every matching table
+	template <typename Func> void each(Func func) const {
+		const auto& tables = mStorage->tables();
+
+		for (std::size_t i = tables.size(); i != 0; --i) {
+			const archetype_table& table = *tables[i - 1];
+			if (!matches(table)) {
+				continue;
+			}
+
+			for (std::size_t row = table.entities.size(); row != 0; --row) {
+				// Erasing the current entity can shrink the table by more than one row
+				row = row > table.entities.size() ? table.entities.size() : row;
+				if (row == 0) {
+					break;
+				}
+
+				if ((mChanged | mAdded) == 0 || accepts(table, row - 1)) {
+					invoke(func, table, row - 1);
+				}
+			}
+		}
+	}
+
+	// Same contract as `lazy_view::par_each`, the rows of each table are split into chunks of `grain`
+	template <typename Func>
+	void par_each(Func func, const std::size_t grain = DEFAULT_GRAIN,
+		      thread_pool& pool = *thread_pool::getInstance()) const {
+		const auto& tables = mStorage->tables();
+
+		for (std::size_t i = tables.size(); i != 0; --i) {
+			const archetype_table& table = *tables[i - 1];
+			if (!matches(table) || table.entities.empty()) {
+				continue;
+			}
+
+			auto chunk = [this, &func, &table](const std::size_t begin, const std::size_t end) {
+				for (std::size_t row = end; row != begin; --row) {
+					if ((mChanged | mAdded) == 0 || accepts(table, row - 1)) {
+						invoke(func, table, row - 1);
+					}
+				}
+			};
+
+			pool.parallel_for(table.entities.size(), grain, chunk);
+		}
+	}
+
+	template <typename Func>
+	void par_each_chunked(Func func, const std::size_t grain = DEFAULT_GRAIN,
+			      thread_pool& pool = *thread_pool::getInstance()) const {
+		const auto& tables = mStorage->tables();
+
+		for (std::size_t i = tables.size(); i != 0; --i) {
+			if (!matches(*tables[i - 1]) || tables[i - 1]->entities.empty()) {
+				continue;
+			}
+
+			auto chunk = [this, &func, i](const std::size_t begin, const std::size_t end) {
+				func(iterable{tuple_iterator{iterator{*this, i, end, i, begin}},
+					      tuple_iterator{iterator{*this, i, begin, i, begin}}});
+			};
+
+			pool.parallel_for(tables[i - 1]->entities.size(), grain, chunk);
+		}
+	}
+
+	// Only keeps the entities whose `Types` were changed (`get_mut`, `patch`, `replace` or added) after `since`
+	template <typename... Types> [[nodiscard]] archetype_view changed(const std::uint64_t since) const noexcept {
+		archetype_view view = *this;
+		view.mChanged |= (bit<Types>() | ...);
+		view.mChangedSince = since;
+
+		return view;
+	}
+
+	// Only keeps the entities that got their `Types` after `since`
+	template <typename... Types> [[nodiscard]] archetype_view added(const std::uint64_t since) const noexcept {
+		archetype_view view = *this;
+		view.mAdded |= (bit<Types>() | ...);
+		view.mAddedSince = since;
+
+		return view;
+	}
+
+	[[nodiscard]] bool contains(const EntityID entity) const noexcept {
+		if (!(mStorage->contains<ComponentTypes>(entity) && ...) ||
+		    (mStorage->contains<Excludes>(entity) || ...)) {
+			return false;
+		}
+
+		const auto [table, row] = mStorage->where(entity);
+
+		return accepts(*table, row);
+	}
+
+	template <typename... Components> [[nodiscard]] decltype(auto) get(const EntityID entity) const {
+		if constexpr (sizeof...(Components) == 1) {
+			return (mStorage->get<Components>(entity), ...);
+		} else {
+			return std::tuple<Components&...>(mStorage->get<Components>(entity)...);
+		}
+	}
+
+	[[nodiscard]] std::tuple<EntityID, ComponentTypes&...> tuple(const EntityID entity) const {
+		return std::tuple<EntityID, ComponentTypes&...>(entity, mStorage->get<ComponentTypes>(entity)...);
+	}
+
+	[[nodiscard]] static std::tuple<EntityID, ComponentTypes&...> tuple_at(const archetype_table& table,
+									       const std::size_t row) noexcept {
+		return std::tuple<EntityID, ComponentTypes&...>(
+			table.entities[row], archetype_storage::column<ComponentTypes>(table)->at(row)...);
+	}
+
+	// Upper bound of the number of entities in the view
+	[[nodiscard]] std::size_t size_hint() const noexcept {
+		std::size_t size = 0;
+		for (const auto& table : mStorage->tables()) {
+			if (matches(*table)) {
+				size += table->entities.size();
+			}
+		}
+
+		return size;
+	}
+
+	[[nodiscard]] archetype_storage* storage() const noexcept { return mStorage; }
+
+	[[nodiscard]] bool matches(const archetype_table& table) const noexcept {
+		return (table.signature & mInclude) == mInclude && (table.signature & mExclude) == 0;
+	}
+
+	// The change filters, the table must match
+	[[nodiscard]] bool accepts(const archetype_table& table, const std::size_t row) const noexcept {
+		for (std::uint64_t bits = mChanged; bits != 0; bits &= bits - 1) {
+			if (table.columns[std::countr_zero(bits)]->ticks(row).changed <= mChangedSince) {
+				return false;
+			}
+		}
+
+		for (std::uint64_t bits = mAdded; bits != 0; bits &= bits - 1) {
+			if (table.columns[std::countr_zero(bits)]->ticks(row).added <= mAddedSince) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+      private:
+	constexpr const static inline std::size_t DEFAULT_GRAIN = 256;
+
+	template <typename Type> [[nodiscard]] static std::uint64_t bit() noexcept {
+		return std::uint64_t(1) << archetype_storage::id<Type>();
+	}
+
+	template <typename Func> static void invoke(Func& func, const archetype_table& table, const std::size_t row) {
+		if constexpr (std::is_invocable_v<Func, EntityID>) {
+			func(table.entities[row]);
+		} else if constexpr (std::is_invocable_v<Func, EntityID, ComponentTypes&...>) {
+			func(table.entities[row], archetype_storage::column<ComponentTypes>(table)->at(row)...);
+		} else if constexpr (std::is_invocable_v<Func, ComponentTypes&...>) {
+			func(archetype_storage::column<ComponentTypes>(table)->at(row)...);
+		} else {
+			static_assert(False<Func>{},
+				      "The signatures for each are: (EntityID), (EntityID, ComponentTypes&...) "
+				      "and (ComponentTypes&...)");
+			std::unreachable();
+		}
+	}
+
+	archetype_storage* mStorage;
+	// Component bits the tables must have, and must not have
+	std::uint64_t mInclude;
+	std::uint64_t mExclude;
+	std::uint64_t mChanged;
+	std::uint64_t mAdded;
+	std::uint64_t mChangedSince;
+	std::uint64_t mAddedSince;
+};
+
+} // namespace utils
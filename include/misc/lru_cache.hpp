@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace utils {
+
+// Values keyed by `Key`, each with a size in bytes given when it is put in. Once they add up to more than the
+// budget, the ones used the longest ago are handed to the eviction callback, so they can be written somewhere else
+// A value that is taken leaves the cache, it's for things that are either in use or cached, never both
+template <typename Key, typename Value> class lru_cache final {
+      public:
+	explicit lru_cache(const std::size_t budget) noexcept : mBudget(budget), mBytes(0) {}
+
+	lru_cache(lru_cache&&) = default;
+	lru_cache(const lru_cache&) = delete;
+	lru_cache& operator=(lru_cache&&) = default;
+	lru_cache& operator=(const lru_cache&) = delete;
+	~lru_cache() = default;
+
+	[[nodiscard]] bool contains(const Key& key) const { return mIndex.contains(key); }
+	[[nodiscard]] std::size_t size() const noexcept { return mEntries.size(); }
+	[[nodiscard]] std::size_t bytes() const noexcept { return mBytes; }
+	[[nodiscard]] std::size_t budget() const noexcept { return mBudget; }
+
+	// Empty if the key isn't cached
+	[[nodiscard]] std::optional<Value> take(const Key& key) {
+		const auto found = mIndex.find(key);
+		if (found == mIndex.end()) {
+			return std::nullopt;
+		}
+
+		const auto cached = found->second;
+		std::optional<Value> value(std::move(cached->value));
+		mBytes -= cached->size;
+		mEntries.erase(cached);
+		mIndex.erase(found);
+
+		return value;
+	}
+
+	// Calls `evict(key, value)` for the least recently put entries until the budget is met again
+	// The new entry is never evicted by its own put, even if it is bigger than the whole budget
+	template <typename Evict> void put(const Key& key, Value value, const std::size_t size, Evict&& evict) {
+		if (const auto found = mIndex.find(key); found != mIndex.end()) {
+			mBytes -= found->second->size;
+			mEntries.erase(found->second);
+			mIndex.erase(found);
+		}
+
+		mEntries.emplace_front(entry{key, std::move(value), size});
+		mIndex.emplace(key, mEntries.begin());
+		mBytes += size;
+
+		while (mBytes > mBudget && mEntries.size() > 1) {
+			auto& last = mEntries.back();
+			mBytes -= last.size;
+			mIndex.erase(last.key);
+			evict(last.key, std::move(last.value));
+			mEntries.pop_back();
+		}
+	}
+
+	// Evicts everything, from the oldest
+	template <typename Evict> void clear(Evict&& evict) {
+		while (!mEntries.empty()) {
+			auto& last = mEntries.back();
+			evict(last.key, std::move(last.value));
+			mEntries.pop_back();
+		}
+
+		mIndex.clear();
+		mBytes = 0;
+	}
+
+      private:
+	struct entry {
+		Key key;
+		Value value;
+		std::size_t size;
+	};
+
+	// The most recent at the front
+	std::list<entry> mEntries;
+	std::unordered_map<Key, typename std::list<entry>::iterator> mIndex;
+	std::size_t mBudget;
+	std::size_t mBytes;
+};
+
+} // namespace utils
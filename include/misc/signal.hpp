@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+// A list of listeners, each one is a member function and the instance it's called on
+// Nothing is allocated per call, publishing is a loop over plain function pointers
+// Listeners must not connect or disconnect while the signal is being published
+template <typename... Args> class signal {
+	struct listener {
+		void* instance;
+		void (*call)(void* instance, Args... args);
+	};
+
+      public:
+	// `signal.connect<&PhysicsSystem::blockAdded>(this)`, connecting twice calls the listener twice
+	template <auto Member, typename Instance> void connect(Instance* const instance) {
+		mListeners.emplace_back(listener{static_cast<void*>(instance), [](void* object, Args... args) {
+							 (static_cast<Instance*>(object)->*Member)(
+								 std::forward<Args>(args)...);
+						 }});
+	}
+
+	// Removes every listener called on `instance`
+	void disconnect(const void* const instance) {
+		std::erase_if(mListeners, [instance](const listener& l) { return l.instance == instance; });
+	}
+
+	[[nodiscard]] bool connected(const void* const instance) const noexcept {
+		return std::ranges::any_of(mListeners,
+					   [instance](const listener& l) { return l.instance == instance; });
+	}
+
+	[[nodiscard]] bool empty() const noexcept { return mListeners.empty(); }
+
+	void publish(Args... args) const {
+		for (const auto& l : mListeners) {
+			l.call(l.instance, args...);
+		}
+	}
+
+      private:
+	std::vector<listener> mListeners;
+};
+
+} // namespace utils
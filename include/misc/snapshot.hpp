@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <source_location>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+// Components that go in snapshots, byte for byte. Tags always do, the others opt in with `PERSISTENT`, as Eigen
+// vectors aren't trivially copyable on paper even though they are plain floats
+// Components holding pointers must not, the pointer means nothing once the snapshot is loaded in another run
+template <typename Component>
+concept persistent = std::is_empty_v<Component> || requires { requires Component::PERSISTENT; };
+
+// Hash of the type's name. Unlike `type_id` it doesn't depend on the order the types were first used in, so it's the
+// same in every run of a build
+template <typename Type> [[nodiscard]] consteval std::uint64_t type_hash() noexcept {
+	const std::string_view name = std::source_location::current().function_name();
+
+	// FNV-1a
+	std::uint64_t hash = 14695981039346656037ULL;
+	for (const char c : name) {
+		hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+// Appends plain values to a byte buffer
+class snapshot_writer final {
+      public:
+	template <typename T> void write(const T& value) {
+		static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be written");
+
+		bytes(&value, sizeof(T));
+	}
+
+	void bytes(const void* const data, const std::size_t size) {
+		if (size == 0) {
+			return;
+		}
+
+		const std::size_t offset = mData.size();
+		mData.resize(offset + size);
+		std::memcpy(mData.data() + offset, data, size);
+	}
+
+	void reserve(const std::size_t capacity) { mData.reserve(capacity); }
+
+	[[nodiscard]] std::vector<std::byte> release() noexcept { return std::move(mData); }
+
+      private:
+	std::vector<std::byte> mData;
+};
+
+// Reads back what a `snapshot_writer` wrote, nothing is read past the end
+class snapshot_reader final {
+      public:
+	explicit snapshot_reader(const std::span<const std::byte> data) noexcept : mData(data), mOffset(0) {}
+
+	template <typename T> [[nodiscard]] bool read(T& value) noexcept {
+		static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be read");
+
+		const std::byte* const data = bytes(sizeof(T));
+		if (data == nullptr) {
+			return false;
+		}
+
+		std::memcpy(&value, data, sizeof(T));
+
+		return true;
+	}
+
+	// The next `size` bytes, null if there aren't that many left
+	[[nodiscard]] const std::byte* bytes(const std::size_t size) noexcept {
+		if (size > mData.size() - mOffset) {
+			return nullptr;
+		}
+
+		const std::byte* const data = mData.data() + mOffset;
+		mOffset += size;
+
+		return data;
+	}
+
+	[[nodiscard]] bool done() const noexcept { return mOffset == mData.size(); }
+
+      private:
+	std::span<const std::byte> mData;
+	std::size_t mOffset;
+};
+
+} // namespace utils
@@ -1,16 +1,70 @@
 #pragma once
 
 #include "managers/entityManager.hpp"
+#include "misc/signal.hpp"
+#include "misc/snapshot.hpp"
 
 #include <SDL3/SDL.h>
 #include <cinttypes>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
 #include <typeinfo>
+#include <utility>
 #include <vector>
 
 namespace utils {
 
+template <class...> struct False : std::bool_constant<false> {};
+
+template <typename Iterator> struct iterable_adaptor final {
+	constexpr iterable_adaptor(Iterator from, Iterator to) noexcept : first{std::move(from)}, last{std::move(to)} {}
+
+	[[nodiscard]] constexpr Iterator begin() const noexcept { return first; }
+	[[nodiscard]] constexpr Iterator cbegin() const noexcept { return begin(); }
+
+	[[nodiscard]] constexpr Iterator end() const noexcept { return last; }
+	[[nodiscard]] constexpr Iterator cend() const noexcept { return end(); }
+
+      private:
+	Iterator first;
+	Iterator last;
+};
+
+// Components an entity must not have to be part of a view, e.g.
+// `scene->view<Components::position>(utils::exclude<Components::block>)`
+template <typename... Types> struct exclude_t final {
+	constexpr exclude_t() noexcept = default;
+};
+
+template <typename... Types> inline constexpr exclude_t<Types...> exclude{};
+
+// When the entity got the component and when it was last changed, see `ComponentManager::advanceTick`
+struct component_ticks {
+	std::uint64_t added;
+	std::uint64_t changed;
+};
+
+// Pools owned by a group report every change to it, so the group can keep its entities packed at the front
+class group_handler_interface {
+      public:
+	virtual ~group_handler_interface() = default;
+
+	// After the entity got its component
+	virtual void emplaced(EntityID entity) = 0;
+	// Before the entity loses its component
+	virtual void erasing(EntityID entity) = 0;
+	virtual void cleared() noexcept = 0;
+	// How many entities are packed at the front of the owned pools
+	[[nodiscard]] virtual std::size_t size() const noexcept = 0;
+};
+
 // TODO: Put common stuff here
 class sparse_set_interface {
 	using underlying_container = std::vector<EntityID>;
@@ -25,6 +79,8 @@ class sparse_set_interface {
 	virtual void clear() = 0;
 	[[nodiscard]] virtual std::size_t size() const noexcept = 0;
 	[[nodiscard]] virtual EntityID* data() noexcept = 0;
+	// The packed entities, the reference stays valid for the lifetime of the pool
+	[[nodiscard]] virtual const underlying_container& packed() const noexcept = 0;
 
 	[[nodiscard]] virtual iterator begin() noexcept = 0;
 	[[nodiscard]] virtual const_iterator begin() const noexcept = 0;
@@ -33,16 +89,44 @@ class sparse_set_interface {
 	[[nodiscard]] virtual iterator end() noexcept = 0;
 	[[nodiscard]] virtual const_iterator end() const noexcept = 0;
 	[[nodiscard]] virtual const_iterator cend() const noexcept = 0;
+
+	// Bumped every time an entity is added to or removed from the pool, views compare it to know if they are
+	// stale
+	[[nodiscard]] std::uint64_t version() const noexcept { return mVersion; }
+
+	// A pool can only be owned by one group, as the group decides the order of its entities
+	[[nodiscard]] group_handler_interface* owner() const noexcept { return mOwner; }
+	void own(group_handler_interface* const owner) noexcept { mOwner = owner; }
+
+	// The tick stamped on added and changed components, shared by all the pools of a scene
+	void set_clock(const std::uint64_t* const clock) noexcept { mClock = clock; }
+	[[nodiscard]] std::uint64_t now() const noexcept { return *mClock; }
+
+      protected:
+	// Pools that aren't in a scene stay at tick 0
+	constexpr const static inline std::uint64_t NO_CLOCK = 0;
+
+	std::uint64_t mVersion = 0;
+	group_handler_interface* mOwner = nullptr;
+	const std::uint64_t* mClock = &NO_CLOCK;
 };
 
 // Prevent the destructor to crash the program due to polymorphism
 inline sparse_set_interface::~sparse_set_interface() {}
 
 // PERF: https://gist.github.com/dakom/82551fff5d2b843cbe1601bbaff2acbf
-template <typename Component> class sparse_set : public sparse_set_interface {
+// The sparse index is split into fixed-size pages that are only allocated once an entity in their range is
+// emplaced, so a pool with a few high IDs doesn't pay for the whole range
+// Empty types are tags: the pool only stores which entities have them, and `get` hands out a shared instance
+template <typename Component> class sparse_set final : public sparse_set_interface {
 	using underlying_container = std::vector<EntityID>;
+	using page_type = std::unique_ptr<std::uintptr_t[]>;
 
       public:
+	// Entities per sparse page, must be a power of two
+	constexpr const static inline std::size_t PAGE_SIZE = 4096;
+	constexpr const static inline bool TAG = std::is_empty_v<Component>;
+
 	using iterator = underlying_container::iterator;
 	using const_iterator = underlying_container::const_iterator;
 
@@ -55,18 +139,75 @@ template <typename Component> class sparse_set : public sparse_set_interface {
 	~sparse_set() override {}
 
 	template <typename... Args> void emplace(const EntityID entity, Args&&... args) {
-		while (mSparseContainer.size() <= entity) {
-			mSparseContainer.emplace_back(0);
-		}
+		push(entity, std::forward<Args>(args)...);
+		++mVersion;
+	}
 
-		if (mSparseContainer[entity] != 0) {
-			SDL_Log("\033[93mSparse_set.cpp: Container already contains entity %" PRIu64 "!\033[0m",
-				entity);
+	// Adds a batch of components, the n-th value goes to the n-th entity
+	// The pool grows once and the version is only bumped once for the whole batch
+	template <typename Values> void insert(const std::span<const EntityID> entities, Values&& values) {
+		SDL_assert(std::size(values) == entities.size() && "Every entity needs a component");
+
+		reserve(mPackedContainer.size() + entities.size());
+
+		auto value = std::begin(values);
+		for (const auto entity : entities) {
+			if constexpr (std::is_rvalue_reference_v<Values&&>) {
+				push(entity, std::move(*value));
+			} else {
+				push(entity, *value);
+			}
+
+			++value;
 		}
 
-		mSparseContainer[entity] = mPackedContainer.size();
-		mPackedContainer.emplace_back(entity);
-		mComponents.emplace_back(std::forward<Args>(args)...);
+		++mVersion;
+	}
+
+	// Swaps the component for a new one built from `args`, the entity must already have one
+	// The pool's version is left alone as no entity came or went
+	template <typename... Args> Component& replace(const EntityID entity, Args&&... args) {
+		Component& component = get_mut(entity);
+		component = Component(std::forward<Args>(args)...);
+		mOnReplace.publish(entity, component);
+
+		return component;
+	}
+
+	// Calls `func(component)` and marks the component as changed, the `on_replace` listeners are told after
+	template <typename Func> Component& patch(const EntityID entity, Func&& func) {
+		Component& component = get_mut(entity);
+		std::forward<Func>(func)(component);
+		mOnReplace.publish(entity, component);
+
+		return component;
+	}
+
+	// Same as `get`, but the component counts as changed, so `changed` filters will pick it up
+	// Writes through `get` aren't tracked. Unlike `patch` nothing is published, which makes it fine to call from
+	// `par_each` on the entity being visited
+	[[nodiscard]] Component& get_mut(const EntityID entity) noexcept {
+		Component& component = get(entity);
+		mTicks[index(entity)].changed = now();
+
+		return component;
+	}
+
+	// Ticks at which the entity got its component and at which it was last changed
+	[[nodiscard]] std::uint64_t added_tick(const EntityID entity) const noexcept {
+		return mTicks[index(entity)].added;
+	}
+	[[nodiscard]] std::uint64_t changed_tick(const EntityID entity) const noexcept {
+		return mTicks[index(entity)].changed;
+	}
+
+	void reserve(const std::size_t capacity) {
+		mPackedContainer.reserve(capacity);
+		mTicks.reserve(capacity);
+
+		if constexpr (!TAG) {
+			mComponents.reserve(capacity);
+		}
 	}
 
 	[[nodiscard]] Component& get(const EntityID entity) noexcept {
@@ -84,15 +225,22 @@ template <typename Component> class sparse_set : public sparse_set_interface {
 		}
 #endif
 
-		return mComponents[mSparseContainer[entity]];
+		if constexpr (TAG) {
+			return sTag;
+		} else {
+			return mComponents[mSparsePages[entityIndex(entity) / PAGE_SIZE]
+						       [entityIndex(entity) % PAGE_SIZE]];
+		}
 	}
 
 	[[nodiscard]] bool contains(const EntityID entity) const noexcept override {
-		if (entity >= mSparseContainer.size() || mSparseContainer[entity] >= mPackedContainer.size()) {
+		const std::uintptr_t* const sparse = find(entity);
+
+		if (sparse == nullptr || *sparse >= mPackedContainer.size()) {
 			return false;
 		}
 
-		return mPackedContainer[mSparseContainer[entity]] == entity;
+		return mPackedContainer[*sparse] == entity;
 	}
 
 	[[nodiscard]] std::size_t size() const noexcept override { return mPackedContainer.size(); }
@@ -120,32 +268,226 @@ template <typename Component> class sparse_set : public sparse_set_interface {
 	[[nodiscard]] bool empty() const noexcept { return mPackedContainer.empty(); }
 
 	[[nodiscard]] EntityID* data() noexcept override { return mPackedContainer.data(); }
+	[[nodiscard]] const underlying_container& packed() const noexcept override { return mPackedContainer; }
 
 	constexpr void clear() override {
+		if (!mOnDestroy.empty()) {
+			for (std::size_t i = 0; i < mPackedContainer.size(); ++i) {
+				if constexpr (TAG) {
+					mOnDestroy.publish(mPackedContainer[i], sTag);
+				} else {
+					mOnDestroy.publish(mPackedContainer[i], mComponents[i]);
+				}
+			}
+		}
+
+		if (mOwner != nullptr) {
+			mOwner->cleared();
+		}
+
 		mPackedContainer.clear();
-		mSparseContainer.clear();
-		mComponents.clear();
+		mSparsePages.clear();
+		mTicks.clear();
+
+		if constexpr (!TAG) {
+			mComponents.clear();
+		}
+
+		++mVersion;
 	}
 
 	void erase(const EntityID entity) noexcept override {
+		// Erasing a missing entity would move the last one over whatever its sparse entry points to
+		SDL_assert(contains(entity) && "Erasing an entity that isn't in the pool");
+
+		if (!mOnDestroy.empty()) {
+			mOnDestroy.publish(entity, get(entity));
+		}
+
+		if (mOwner != nullptr) {
+			mOwner->erasing(entity);
+		}
+
 		// https://gist.github.com/dakom/82551fff5d2b843cbe1601bbaff2acbf
-		mSparseContainer[mPackedContainer.back()] = mSparseContainer[entity];
-		mPackedContainer[mSparseContainer[entity]] = mPackedContainer.back();
-		mComponents[mSparseContainer[entity]] = mComponents.back();
+		std::uintptr_t& sparse = mSparsePages[entityIndex(entity) / PAGE_SIZE][entityIndex(entity) % PAGE_SIZE];
+		const EntityID last = mPackedContainer.back();
+
+		mSparsePages[entityIndex(last) / PAGE_SIZE][entityIndex(last) % PAGE_SIZE] = sparse;
+		mPackedContainer[sparse] = last;
+		mTicks[sparse] = mTicks.back();
 		mPackedContainer.pop_back();
-		mComponents.pop_back();
+		mTicks.pop_back();
+
+		if constexpr (!TAG) {
+			mComponents[sparse] = std::move(mComponents.back());
+			mComponents.pop_back();
+		}
+
+		sparse = 0; // 1. The index of EntityIndices, equal to the value of the
+			    // entity, is removed (leaving a hole)
+		++mVersion;
+	}
+
+	// Replaces the pool with `entities`, their components are packed back to back in `values` like `raw` has them
+	// The components count as added now, and the construct listeners are told like for `insert`
+	void restore(const std::span<const EntityID> entities, const std::byte* const values)
+		requires persistent<Component>
+	{
+		clear();
+		reserve(entities.size());
+
+		mPackedContainer.assign(entities.begin(), entities.end());
+		mTicks.assign(entities.size(), component_ticks{now(), now()});
+
+		if constexpr (!TAG) {
+			// The bytes may not be aligned, so each component is copied out first
+			alignas(Component) std::byte value[sizeof(Component)];
+			for (std::size_t i = 0; i < entities.size(); ++i) {
+				std::memcpy(value, values + i * sizeof(Component), sizeof(Component));
+				mComponents.emplace_back(*std::launder(reinterpret_cast<const Component*>(value)));
+			}
+		}
+
+		for (std::size_t i = 0; i < mPackedContainer.size(); ++i) {
+			assure(mPackedContainer[i]) = i;
+		}
+
+		// A group only takes the entities that have all its components, so the last of its pools restored sorts
+		// them in
+		if (mOwner != nullptr) {
+			for (const auto entity : entities) {
+				mOwner->emplaced(entity);
+			}
+		}
 
-		mSparseContainer[entity] = 0; // 1. The index of EntityIndices, equal to the value of the
-					      // entity, is removed (leaving a hole)
+		if (!mOnConstruct.empty()) {
+			for (const auto entity : entities) {
+				mOnConstruct.publish(entity, get(entity));
+			}
+		}
+
+		++mVersion;
+	}
+
+	// Position of the entity in the packed arrays, the entity must be in the pool
+	[[nodiscard]] std::size_t index(const EntityID entity) const noexcept { return *find(entity); }
+
+	// The components, in the same order as the packed entities
+	[[nodiscard]] Component* raw() noexcept
+		requires(!TAG)
+	{
+		return mComponents.data();
+	}
+
+	// Swaps the places of two entities in the packed arrays, used by groups to sort the pool
+	void swap_elements(const EntityID lhs, const EntityID rhs) noexcept {
+		if (lhs == rhs) {
+			return;
+		}
+
+		std::uintptr_t& left = mSparsePages[entityIndex(lhs) / PAGE_SIZE][entityIndex(lhs) % PAGE_SIZE];
+		std::uintptr_t& right = mSparsePages[entityIndex(rhs) / PAGE_SIZE][entityIndex(rhs) % PAGE_SIZE];
+
+		std::swap(mPackedContainer[left], mPackedContainer[right]);
+		std::swap(mTicks[left], mTicks[right]);
+		if constexpr (!TAG) {
+			std::swap(mComponents[left], mComponents[right]);
+		}
+		std::swap(left, right);
+	}
+
+	// Published once the entity got its component, groups owning the pool have already been told
+	[[nodiscard]] signal<EntityID, Component&>& on_construct() noexcept { return mOnConstruct; }
+	// Published before the component goes away, so it can still be read
+	[[nodiscard]] signal<EntityID, Component&>& on_destroy() noexcept { return mOnDestroy; }
+	// Published by `replace`, after the new value is in place
+	[[nodiscard]] signal<EntityID, Component&>& on_replace() noexcept { return mOnReplace; }
+
+	// Bytes used by the sparse index, handy to check the paging
+	[[nodiscard]] std::size_t sparse_bytes() const noexcept {
+		std::size_t bytes = mSparsePages.capacity() * sizeof(page_type);
+
+		for (const auto& page : mSparsePages) {
+			if (page) {
+				bytes += PAGE_SIZE * sizeof(std::uintptr_t);
+			}
+		}
+
+		return bytes;
 	}
 
       private:
-	// Index is entity ID, value is ptr to packed container
-	std::vector<std::uintptr_t> mSparseContainer;
+	static_assert((PAGE_SIZE & (PAGE_SIZE - 1)) == 0, "The page size must be a power of two");
+
+	template <typename... Args> void push(const EntityID entity, Args&&... args) {
+		std::uintptr_t& sparse = assure(entity);
+
+		if (sparse != 0) {
+			SDL_Log("\033[93mSparse_set.cpp: Container already contains entity %" PRIu64 "!\033[0m",
+				entity);
+		}
+
+		sparse = mPackedContainer.size();
+		mPackedContainer.emplace_back(entity);
+		mTicks.emplace_back(now(), now());
+		if constexpr (!TAG) {
+			mComponents.emplace_back(std::forward<Args>(args)...);
+		}
+
+		if (mOwner != nullptr) {
+			mOwner->emplaced(entity);
+		}
+
+		// The group may have moved the component, so look it up again
+		if (!mOnConstruct.empty()) {
+			mOnConstruct.publish(entity, get(entity));
+		}
+	}
+
+	// Returns the sparse slot of the entity, nullptr if the page isn't allocated
+	[[nodiscard]] const std::uintptr_t* find(const EntityID entity) const noexcept {
+		const std::size_t page = entityIndex(entity) / PAGE_SIZE;
+
+		if (page >= mSparsePages.size() || !mSparsePages[page]) {
+			return nullptr;
+		}
+
+		return &mSparsePages[page][entityIndex(entity) % PAGE_SIZE];
+	}
+
+	// Returns the sparse slot of the entity, allocating the page if needed
+	[[nodiscard]] std::uintptr_t& assure(const EntityID entity) {
+		const std::size_t page = entityIndex(entity) / PAGE_SIZE;
+
+		if (page >= mSparsePages.size()) {
+			mSparsePages.resize(page + 1);
+		}
+
+		if (!mSparsePages[page]) {
+			// Value initialized, so every slot is a hole
+			mSparsePages[page] = std::make_unique<std::uintptr_t[]>(PAGE_SIZE);
+		}
+
+		return mSparsePages[page][entityIndex(entity) % PAGE_SIZE];
+	}
+
+	// Index is entity index / PAGE_SIZE, null pages mean the whole range is empty
+	// Inside a page the index is entity index % PAGE_SIZE, value is ptr to packed container
+	// The packed container keeps the full handle, so a stale generation fails `contains`
+	std::vector<page_type> mSparsePages;
 	// Value is entity ID, index is ptr to component
 	underlying_container mPackedContainer;
-	// The real values
-	std::vector<Component> mComponents;
+	// The real values, tags have none
+	[[no_unique_address]] std::conditional_t<TAG, std::tuple<>, std::vector<Component>> mComponents;
+	// What `get` returns for tags, there's nothing in it to change
+	static inline Component sTag{};
+	// Same order as the components
+	std::vector<component_ticks> mTicks;
+
+	// Listeners must not add to or remove from this pool
+	signal<EntityID, Component&> mOnConstruct;
+	signal<EntityID, Component&> mOnDestroy;
+	signal<EntityID, Component&> mOnReplace;
 };
 
 } // namespace utils
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "managers/entityManager.hpp"
+#include "misc/sparse_set.hpp"
+
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+// Keeps the entities that have all of the owned components at the front of every owned pool, in the same order
+// So the n-th component of each pool belongs to the same entity and a group can walk them as parallel arrays
+template <typename... Owned> class group_handler final : public group_handler_interface {
+	static_assert(sizeof...(Owned) > 1, "A group needs at least two components");
+	static_assert((!sparse_set<Owned>::TAG && ...), "Tags have nothing to pack, view them instead");
+
+      public:
+	explicit group_handler(sparse_set<Owned>*... pools) noexcept : mPools(pools...), mLength(0) {
+		const bool free = ((pools->owner() == nullptr) && ...);
+		SDL_assert(free && "A component can only be owned by one group");
+		(void)free;
+
+		(pools->own(this), ...);
+
+		// Sort in the entities that are already there
+		auto* const lead = std::get<0>(mPools);
+		for (std::size_t i = 0; i < lead->size(); ++i) {
+			emplaced(lead->packed()[i]);
+		}
+	}
+
+	group_handler(group_handler&&) = delete;
+	group_handler(const group_handler&) = delete;
+	group_handler& operator=(group_handler&&) = delete;
+	group_handler& operator=(const group_handler&) = delete;
+	~group_handler() override {
+		std::apply([](auto*... pool) { (pool->own(nullptr), ...); }, mPools);
+	}
+
+	void emplaced(const EntityID entity) override {
+		if (!std::apply([entity](const auto*... pool) { return (pool->contains(entity) && ...); }, mPools)) {
+			return;
+		}
+
+		// Already part of the group
+		if (std::get<0>(mPools)->index(entity) < mLength) {
+			return;
+		}
+
+		std::apply(
+			[this, entity](auto*... pool) { (pool->swap_elements(pool->packed()[mLength], entity), ...); },
+			mPools);
+		++mLength;
+	}
+
+	void erasing(const EntityID entity) override {
+		// Only the entities in the group are at the front of the first pool
+		const auto* const lead = std::get<0>(mPools);
+		if (!lead->contains(entity) || lead->index(entity) >= mLength) {
+			return;
+		}
+
+		--mLength;
+		std::apply(
+			[this, entity](auto*... pool) { (pool->swap_elements(pool->packed()[mLength], entity), ...); },
+			mPools);
+	}
+
+	void cleared() noexcept override { mLength = 0; }
+
+	[[nodiscard]] std::size_t size() const noexcept override { return mLength; }
+	[[nodiscard]] const std::tuple<sparse_set<Owned>*...>& pools() const noexcept { return mPools; }
+
+      private:
+	std::tuple<sparse_set<Owned>*...> mPools;
+	std::size_t mLength;
+};
+
+template <typename... Owned> class group_iterator final {
+      public:
+	group_iterator(const group_handler<Owned...>* handler, std::size_t offset) noexcept
+		: mHandler(handler), mOffset(offset) {}
+
+	group_iterator& operator++() noexcept { return --mOffset, *this; }
+
+	[[nodiscard]] std::tuple<EntityID, Owned&...> operator*() const noexcept {
+		const std::size_t index = mOffset - 1;
+
+		const auto& pools = mHandler->pools();
+
+		return std::tuple<EntityID, Owned&...>(std::get<0>(pools)->packed()[index],
+						       std::get<sparse_set<Owned>*>(pools)->raw()[index]...);
+	}
+
+	[[nodiscard]] std::size_t index() const noexcept { return mOffset; }
+
+      private:
+	const group_handler<Owned...>* mHandler;
+	std::size_t mOffset;
+};
+
+template <typename... Owned>
+[[nodiscard]] bool operator==(const group_iterator<Owned...>& lhs, const group_iterator<Owned...>& rhs) noexcept {
+	return lhs.index() == rhs.index();
+}
+
+// Owning group, e.g. `scene->group<Components::block, Components::collision, Components::texture>()`
+// Walks the front of the owned pools linearly, no lookups needed to get the components
+// Iteration goes backwards, so the current entity may be erased and new entities may be created while iterating
+template <typename... Owned> class group final {
+      public:
+	using iterator = group_iterator<Owned...>;
+	using iterable = iterable_adaptor<iterator>;
+
+	explicit group(const group_handler<Owned...>* handler) noexcept : mHandler(handler) {}
+
+	[[nodiscard]] iterable each() const noexcept {
+		return iterable{iterator{mHandler, mHandler->size()}, iterator{mHandler, 0}};
+	}
+
+	template <typename Func> void each(Func func) const {
+		const auto& pools = mHandler->pools();
+		const auto* const entities = &std::get<0>(pools)->packed();
+
+		for (std::size_t i = mHandler->size(); i != 0; --i) {
+			const std::size_t index = i - 1;
+
+			if constexpr (std::is_invocable_v<Func, EntityID>) {
+				func((*entities)[index]);
+			} else if constexpr (std::is_invocable_v<Func, EntityID, Owned&...>) {
+				func((*entities)[index], std::get<sparse_set<Owned>*>(pools)->raw()[index]...);
+			} else if constexpr (std::is_invocable_v<Func, Owned&...>) {
+				func(std::get<sparse_set<Owned>*>(pools)->raw()[index]...);
+			} else {
+				static_assert(False<Func>{},
+					      "The signatures for each are: (EntityID), (EntityID, Owned&...) and "
+					      "(Owned&...)");
+				std::unreachable();
+			}
+		}
+	}
+
+	[[nodiscard]] bool contains(const EntityID entity) const noexcept {
+		const auto* const lead = std::get<0>(mHandler->pools());
+
+		return lead->contains(entity) && lead->index(entity) < mHandler->size();
+	}
+
+	// The entities of the group, valid until the next change to one of the owned pools
+	[[nodiscard]] const EntityID* data() const noexcept { return std::get<0>(mHandler->pools())->packed().data(); }
+
+	[[nodiscard]] std::size_t size() const noexcept { return mHandler->size(); }
+	[[nodiscard]] bool empty() const noexcept { return mHandler->size() == 0; }
+
+      private:
+	const group_handler<Owned...>* mHandler;
+};
+
+} // namespace utils
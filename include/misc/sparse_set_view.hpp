@@ -2,10 +2,13 @@
 
 #include "managers/componentManager.hpp"
 #include "managers/entityManager.hpp"
+#include "misc/thread_pool.hpp"
 
 #include <SDL3/SDL.h>
 #include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <tuple>
 #include <type_traits>
@@ -14,36 +17,20 @@
 
 namespace utils {
 
-template <class...> struct False : std::bool_constant<false> {};
-
-template <typename Iterator> struct iterable_adaptor final {
-	constexpr iterable_adaptor(Iterator from, Iterator to) noexcept : first{std::move(from)}, last{std::move(to)} {}
-
-	[[nodiscard]] constexpr Iterator begin() const noexcept { return first; }
-	[[nodiscard]] constexpr Iterator cbegin() const noexcept { return begin(); }
-
-	[[nodiscard]] constexpr Iterator end() const noexcept { return last; }
-	[[nodiscard]] constexpr Iterator cend() const noexcept { return end(); }
-
-      private:
-	Iterator first;
-	Iterator last;
-};
-
 template <typename... ComponentTypes> class sparse_set_view_tuple_iterator final {
       public:
-	// mEntities is copied, but it shouldn't - bad for perf
+	// The entities are owned by the view, which must outlive the iterator
 	sparse_set_view_tuple_iterator(ComponentManager* componentManager, const std::vector<EntityID>& entities,
 				       std::size_t offset) noexcept
-		: mComponentManager(componentManager), mEntities(entities), mOffset(offset) {}
+		: mComponentManager(componentManager), mEntities(&entities), mOffset(offset) {}
 
 	sparse_set_view_tuple_iterator& operator++() noexcept { return ++mOffset, *this; }
 
 	sparse_set_view_tuple_iterator& operator--() noexcept { return --mOffset, *this; }
 
 	[[nodiscard]] decltype(auto) operator[](const size_t value) const noexcept {
-		return std::make_tuple(mEntities[index() + value], mComponentManager->getPool<ComponentTypes>()->get(
-									   mEntities[index() + value])...);
+		return std::make_tuple((*mEntities)[index() + value],
+				       mComponentManager->get<ComponentTypes>((*mEntities)[index() + value])...);
 	}
 
 	[[nodiscard]] decltype(auto) operator*() const noexcept { return operator[](0); }
@@ -52,7 +39,7 @@ template <typename... ComponentTypes> class sparse_set_view_tuple_iterator final
 
       protected:
 	class ComponentManager* mComponentManager;
-	const std::vector<EntityID> mEntities;
+	const std::vector<EntityID>* mEntities;
 	std::size_t mOffset;
 };
 
@@ -84,42 +71,16 @@ class sparse_set_view {
 	using iterable = iterable_adaptor<sparse_set_view_tuple_iterator<ComponentTypes...>>;
 
 	// PERF: Large bottleneck
-	sparse_set_view() noexcept {
-		if constexpr (sizeof...(ComponentTypes) == 1) {
-			const auto& c = *(static_cast<utils::sparse_set<ComponentTypes>*>(
-						  ComponentManager::getInstance()->getPool<ComponentTypes>()),
-					  ...);
-			mEntities = std::vector<EntityID>(c.begin(), c.end());
-		} else {
-			// This first part makes a array of all the sizes of the that we loop through
-			const std::array<utils::sparse_set_interface*, sizeof...(ComponentTypes)> sets = {
-				ComponentManager::getInstance()->getPool<ComponentTypes>()...};
-
-			std::size_t smallest = 0;
-			std::size_t smallest_size = sets[0]->size();
-			for (std::size_t i = 0; i < sizeof...(ComponentTypes); ++i) {
-				if (sets[i]->size() < smallest_size) {
-					smallest = i;
-					smallest_size = sets[i]->size();
-				}
-			}
+	explicit sparse_set_view(ComponentManager* componentManager) noexcept : mComponentManager(componentManager) {
+		const auto view = mComponentManager->view<ComponentTypes...>();
+		mEntities.reserve(view.size_hint());
 
-			mEntities.reserve(smallest_size);
-
-			for (const auto id : *sets[smallest]) {
-				if constexpr (sizeof...(ComponentTypes) == 1) {
-					mEntities.emplace_back(id);
-				} else {
-					if ((... &&
-					     (ComponentManager::getInstance()->getPool<ComponentTypes>()->contains(
-						     id)))) {
-						mEntities.emplace_back(id);
-					}
-				}
-			}
+		for (const auto entity : view) {
+			mEntities.emplace_back(entity);
 		}
-		// Now at the end of the program, all the entites that are present in all the components are
-		// present in mEntities (doesn't count in addition and deletion)
+
+		// Views walk backwards, this keeps the storage order
+		std::ranges::reverse(mEntities);
 	}
 
 	// Copy
@@ -141,15 +102,15 @@ class sparse_set_view {
 	[[nodiscard]] const_iterator cend() const noexcept { return end(); }
 
 	[[nodiscard]] iterable each() const noexcept {
-		return iterable{tuple_iterator{ComponentManager::getInstance(), mEntities, 0},
-				tuple_iterator{ComponentManager::getInstance(), mEntities, mEntities.size()}};
+		return iterable{tuple_iterator{mComponentManager, mEntities, 0},
+				tuple_iterator{mComponentManager, mEntities, mEntities.size()}};
 	}
 
 	template <typename... Components> [[nodiscard]] decltype(auto) get(const EntityID entt) const {
 		if constexpr (sizeof...(Components) == 1) {
-			return (ComponentManager::getInstance()->getPool<Components>()->get(entt), ...);
+			return (mComponentManager->get<Components>(entt), ...);
 		} else {
-			return std::make_tuple(ComponentManager::getInstance()->getPool<Components>()->get(entt)...);
+			return std::make_tuple(mComponentManager->get<Components>(entt)...);
 		}
 	}
 
@@ -160,12 +121,11 @@ class sparse_set_view {
 			}
 		} else if constexpr (std::is_invocable_v<Func, EntityID, ComponentTypes&...>) {
 			for (const auto entity : mEntities) {
-				func(entity,
-				     ComponentManager::getInstance()->getPool<ComponentTypes>()->get(entity)...);
+				func(entity, mComponentManager->get<ComponentTypes>(entity)...);
 			}
 		} else if constexpr (std::is_invocable_v<Func, ComponentTypes&...>) {
 			for (const auto entity : mEntities) {
-				func(ComponentManager::getInstance()->getPool<ComponentTypes>()->get(entity)...);
+				func(mComponentManager->get<ComponentTypes>(entity)...);
 			}
 		} else {
 			static_assert(False<Func>{}, "The signatures for each are: (EntityID), (EntityID, ComponentTypes&...) "
@@ -180,7 +140,245 @@ class sparse_set_view {
 	constexpr const EntityID* data() const noexcept { return mEntities.data(); }
 
       private:
+	ComponentManager* mComponentManager;
 	std::vector<EntityID> mEntities;
 };
 
+// Walks the packed entities of the leading pool backwards, skipping the ones the view rejects
+// Going backwards means erasing the current entity or appending new ones doesn't break the iteration
+// The view is copied (it's just a few pointers), so iterating over a temporary view is fine
+template <typename View> class lazy_view_iterator final {
+      public:
+	// `floor` is where the range ends, so a chunk of the packed entities can be walked on its own
+	lazy_view_iterator(const View& view, const std::vector<EntityID>* entities, std::size_t offset,
+			   std::size_t floor = 0) noexcept
+		: mView(view), mEntities(entities), mOffset(offset), mFloor(floor) {
+		skip();
+	}
+
+	lazy_view_iterator& operator++() noexcept { return --mOffset, skip(), *this; }
+
+	[[nodiscard]] EntityID operator*() const noexcept { return (*mEntities)[mOffset - 1]; }
+
+	[[nodiscard]] std::size_t index() const noexcept { return mOffset; }
+
+      private:
+	void skip() noexcept {
+		while (mOffset != mFloor && !mView.contains((*mEntities)[mOffset - 1])) {
+			--mOffset;
+		}
+	}
+
+	View mView;
+	const std::vector<EntityID>* mEntities;
+	std::size_t mOffset;
+	std::size_t mFloor;
+};
+
+template <typename View>
+[[nodiscard]] bool operator==(const lazy_view_iterator<View>& lhs, const lazy_view_iterator<View>& rhs) noexcept {
+	return lhs.index() == rhs.index();
+}
+
+template <typename View> class lazy_view_tuple_iterator final {
+      public:
+	lazy_view_tuple_iterator(const View& view, lazy_view_iterator<View> it) noexcept : mView(view), mIt(it) {}
+
+	lazy_view_tuple_iterator& operator++() noexcept { return ++mIt, *this; }
+
+	[[nodiscard]] decltype(auto) operator*() const noexcept { return mView.tuple(*mIt); }
+
+	[[nodiscard]] std::size_t index() const noexcept { return mIt.index(); }
+
+      private:
+	View mView;
+	lazy_view_iterator<View> mIt;
+};
+
+template <typename View>
+[[nodiscard]] bool operator==(const lazy_view_tuple_iterator<View>& lhs,
+			      const lazy_view_tuple_iterator<View>& rhs) noexcept {
+	return lhs.index() == rhs.index();
+}
+
+template <typename, typename...> class lazy_view;
+
+// A view that doesn't copy anything: it iterates the smallest pool in place and checks the other pools on the fly
+// Unlike `sparse_set_view` it never allocates, but it is only valid as long as the pools it points to
+// The current entity may be erased and new entities may be created while iterating, other erases are not safe
+// Components may be emplaced while iterating, except into a group whose pool the view walks: the entity that joins
+// the group swaps places with one that wasn't visited yet, so that one would be skipped. Defer those emplaces
+template <typename... Excludes, typename... ComponentTypes>
+class lazy_view<exclude_t<Excludes...>, ComponentTypes...> {
+	static_assert(sizeof...(ComponentTypes) > 0, "A view needs at least one component");
+
+      public:
+	using iterator = lazy_view_iterator<lazy_view>;
+	using tuple_iterator = lazy_view_tuple_iterator<lazy_view>;
+	using iterable = iterable_adaptor<tuple_iterator>;
+
+	lazy_view(const std::tuple<sparse_set<ComponentTypes>*...>& pools,
+		  const std::tuple<sparse_set<Excludes>*...>& excludes) noexcept
+		: mPools(pools), mExcludes(excludes), mLead(nullptr), mEntities(nullptr), mChanged(0), mAdded(0),
+		  mChangedSince(0), mAddedSince(0) {
+		const auto lead = [this](const sparse_set_interface* pool) {
+			if (mEntities == nullptr || pool->size() < mEntities->size()) {
+				mLead = pool;
+				mEntities = &pool->packed();
+			}
+		};
+
+		std::apply([&lead](const auto*... pool) { (lead(pool), ...); }, mPools);
+	}
+
+	[[nodiscard]] iterator begin() const noexcept { return iterator{*this, mEntities, mEntities->size()}; }
+	[[nodiscard]] iterator cbegin() const noexcept { return begin(); }
+
+	[[nodiscard]] iterator end() const noexcept { return iterator{*this, mEntities, 0}; }
+	[[nodiscard]] iterator cend() const noexcept { return end(); }
+
+	[[nodiscard]] iterable each() const noexcept {
+		return iterable{tuple_iterator{*this, begin()}, tuple_iterator{*this, end()}};
+	}
+
+	template <typename Func> void each(Func func) const {
+		// Catches the emplaces that should have been deferred, the group only grows through them
+		const group_handler_interface* const group = mLead->owner();
+		[[maybe_unused]] std::size_t grouped = group == nullptr ? 0 : group->size();
+
+		for (const auto entity : *this) {
+			invoke(func, entity);
+
+			if (group != nullptr) {
+				SDL_assert(group->size() <= grouped &&
+					   "Emplaced into a group while walking its pool, defer the emplace");
+				grouped = group->size();
+			}
+		}
+	}
+
+	// Same as `each`, but the packed entities are split into chunks of `grain` that run on the thread pool
+	// While it runs, `func` may:
+	// - read and write the components it is given, they belong to the current entity only
+	// - read (get, contains, valid) any other component
+	// It may not create or erase entities, emplace components (deferred commands included), write
+	// components of other entities or make views. Anything shared must be synchronized by the caller
+	// The order of the calls is unspecified
+	template <typename Func>
+	void par_each(Func func, const std::size_t grain = DEFAULT_GRAIN,
+		      thread_pool& pool = *thread_pool::getInstance()) const {
+		auto chunk = [this, &func](const std::size_t begin, const std::size_t end) {
+			const iterator last{*this, mEntities, begin, begin};
+			for (iterator it{*this, mEntities, end, begin}; it != last; ++it) {
+				invoke(func, *it);
+			}
+		};
+
+		pool.parallel_for(mEntities->size(), grain, chunk);
+	}
+
+	// Calls `func(chunk)` once per chunk, where `chunk` iterates `std::tuple<EntityID, ComponentTypes&...>`
+	// like `each()`. Handy to keep a per chunk accumulator. The contract is the same as `par_each`
+	template <typename Func>
+	void par_each_chunked(Func func, const std::size_t grain = DEFAULT_GRAIN,
+			      thread_pool& pool = *thread_pool::getInstance()) const {
+		auto chunk = [this, &func](const std::size_t begin, const std::size_t end) {
+			func(iterable{tuple_iterator{*this, iterator{*this, mEntities, end, begin}},
+				      tuple_iterator{*this, iterator{*this, mEntities, begin, begin}}});
+		};
+
+		pool.parallel_for(mEntities->size(), grain, chunk);
+	}
+
+	// Only keeps the entities whose `Types` were changed (`get_mut`, `patch`, `replace` or added) after `since`
+	// `Types` must be components of the view
+	template <typename... Types> [[nodiscard]] lazy_view changed(const std::uint64_t since) const noexcept {
+		lazy_view view = *this;
+		view.mChanged |= (bit<Types>() | ...);
+		view.mChangedSince = since;
+
+		return view;
+	}
+
+	// Only keeps the entities that got their `Types` after `since`
+	template <typename... Types> [[nodiscard]] lazy_view added(const std::uint64_t since) const noexcept {
+		lazy_view view = *this;
+		view.mAdded |= (bit<Types>() | ...);
+		view.mAddedSince = since;
+
+		return view;
+	}
+
+	[[nodiscard]] bool contains(const EntityID entity) const noexcept {
+		return std::apply([entity](const auto*... pool) { return (pool->contains(entity) && ...); }, mPools) &&
+		       std::apply([entity](const auto*... pool) { return (!pool->contains(entity) && ...); },
+				  mExcludes) &&
+		       ((mChanged | mAdded) == 0 || fresh(entity, std::index_sequence_for<ComponentTypes...>{}));
+	}
+
+	template <typename... Components> [[nodiscard]] decltype(auto) get(const EntityID entity) const {
+		if constexpr (sizeof...(Components) == 1) {
+			return (std::get<sparse_set<Components>*>(mPools)->get(entity), ...);
+		} else {
+			return std::tuple<Components&...>(std::get<sparse_set<Components>*>(mPools)->get(entity)...);
+		}
+	}
+
+	// The components are references into the pools, unlike `sparse_set_view::each`
+	[[nodiscard]] std::tuple<EntityID, ComponentTypes&...> tuple(const EntityID entity) const {
+		return std::tuple<EntityID, ComponentTypes&...>(
+			entity, std::get<sparse_set<ComponentTypes>*>(mPools)->get(entity)...);
+	}
+
+	// Upper bound of the number of entities in the view
+	[[nodiscard]] std::size_t size_hint() const noexcept { return mEntities->size(); }
+
+      private:
+	// Entities per chunk for `par_each`, small enough to balance and big enough to be worth a task
+	constexpr const static inline std::size_t DEFAULT_GRAIN = 256;
+
+	template <typename Type> [[nodiscard]] constexpr static std::uint32_t bit() noexcept {
+		constexpr std::array<bool, sizeof...(ComponentTypes)> same = {std::is_same_v<Type, ComponentTypes>...};
+		static_assert(std::ranges::find(same, true) != same.end(),
+			      "Only the components of the view can be filtered");
+
+		return std::uint32_t(1) << (std::ranges::find(same, true) - same.begin());
+	}
+
+	// The entity is in every pool already, only the ticks are left to check
+	template <std::size_t... Index>
+	[[nodiscard]] bool fresh(const EntityID entity, std::index_sequence<Index...>) const noexcept {
+		return ((!(mChanged >> Index & 1) || std::get<Index>(mPools)->changed_tick(entity) > mChangedSince) &&
+			...) &&
+		       ((!(mAdded >> Index & 1) || std::get<Index>(mPools)->added_tick(entity) > mAddedSince) && ...);
+	}
+
+	template <typename Func> void invoke(Func& func, const EntityID entity) const {
+		if constexpr (std::is_invocable_v<Func, EntityID>) {
+			func(entity);
+		} else if constexpr (std::is_invocable_v<Func, EntityID, ComponentTypes&...>) {
+			func(entity, std::get<sparse_set<ComponentTypes>*>(mPools)->get(entity)...);
+		} else if constexpr (std::is_invocable_v<Func, ComponentTypes&...>) {
+			func(std::get<sparse_set<ComponentTypes>*>(mPools)->get(entity)...);
+		} else {
+			static_assert(False<Func>{},
+				      "The signatures for each are: (EntityID), (EntityID, ComponentTypes&...) "
+				      "and (ComponentTypes&...)");
+			std::unreachable();
+		}
+	}
+
+	std::tuple<sparse_set<ComponentTypes>*...> mPools;
+	std::tuple<sparse_set<Excludes>*...> mExcludes;
+	// The smallest pool, and its packed entities
+	const sparse_set_interface* mLead;
+	const std::vector<EntityID>* mEntities;
+
+	// A bit per component of the view, set for the ones filtered on
+	std::uint32_t mChanged;
+	std::uint32_t mAdded;
+	std::uint64_t mChangedSince;
+	std::uint64_t mAddedSince;
+};
+
 } // namespace utils
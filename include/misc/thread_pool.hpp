@@ -0,0 +1,243 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+// A fixed set of workers, each with its own queue. A worker takes from the front of its own queue, and once it
+// runs dry it steals from the back of the others
+// The thread calling `parallel_for` works too, so there is one worker less than there are cores
+// Work can also be handed off with `submit`, the caller doesn't wait for it and never runs it while helping out
+// On the web there are no threads, and everything runs on the caller
+class thread_pool final {
+	struct task {
+		void (*run)(void* context, std::size_t begin, std::size_t end);
+		void* context;
+		std::size_t begin;
+		std::size_t end;
+		// Null for submitted tasks, nobody waits on them
+		std::atomic<std::size_t>* remaining;
+	};
+
+	struct task_queue {
+		std::mutex mutex;
+		std::deque<task> tasks;
+	};
+
+      public:
+	explicit thread_pool(const std::size_t workers = defaultWorkers()) : mQueues(workers), mNext(0) {
+		for (auto& queue : mQueues) {
+			queue = std::make_unique<task_queue>();
+		}
+
+		mWorkers.reserve(workers);
+		for (std::size_t i = 0; i < workers; ++i) {
+			mWorkers.emplace_back([this, i] { work(i); });
+		}
+	}
+
+	thread_pool(thread_pool&&) = delete;
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(thread_pool&&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	~thread_pool() {
+		{
+			std::lock_guard lock(mSleepMutex);
+			mStop = true;
+		}
+		mWake.notify_all();
+
+		for (auto& worker : mWorkers) {
+			worker.join();
+		}
+	}
+
+	static thread_pool* getInstance() {
+		static thread_pool pool;
+		return &pool;
+	}
+
+	// Threads that take part in `parallel_for`, the caller included
+	[[nodiscard]] std::size_t size() const noexcept { return mWorkers.size() + 1; }
+
+	// Calls `func(begin, end)` over [0, count) in chunks of at most `grain`, and returns once every chunk is done
+	// The chunks run at the same time, so `func` must only touch what belongs to its own range
+	template <typename Func> void parallel_for(const std::size_t count, std::size_t grain, Func&& func) {
+		if (count == 0) {
+			return;
+		}
+
+		grain = grain == 0 ? 1 : grain;
+		const std::size_t chunks = (count + grain - 1) / grain;
+		if (mWorkers.empty() || chunks == 1) {
+			func(std::size_t(0), count);
+
+			return;
+		}
+
+		std::atomic<std::size_t> remaining = chunks;
+		const auto run = [](void* context, const std::size_t begin, const std::size_t end) {
+			(*static_cast<std::remove_reference_t<Func>*>(context))(begin, end);
+		};
+
+		// Counted before they're queued, so a worker that takes one right away can't bring it below zero
+		mPending.fetch_add(chunks, std::memory_order_relaxed);
+
+		// Deal the chunks round robin, stealing evens it out if some are slower
+		for (std::size_t begin = 0; begin < count; begin += grain) {
+			const std::size_t end = begin + grain < count ? begin + grain : count;
+			auto& queue = *mQueues[mNext++ % mQueues.size()];
+
+			std::lock_guard lock(queue.mutex);
+			queue.tasks.push_back(task{run, static_cast<void*>(&func), begin, end, &remaining});
+		}
+		wake(true);
+
+		// Help out instead of waiting, but only with the chunks, a submitted task could take much longer
+		while (remaining.load(std::memory_order_acquire) != 0) {
+			task t;
+			if (steal(0, t, false)) {
+				execute(t);
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	// Runs `func()` on a worker and returns right away, whatever it needs must outlive it or be captured by value
+	// Without workers it runs before returning
+	template <typename Func> void submit(Func&& func) {
+		using function = std::decay_t<Func>;
+
+		if (mWorkers.empty()) {
+			func();
+
+			return;
+		}
+
+		const auto run = [](void* context, const std::size_t, const std::size_t) {
+			const std::unique_ptr<function> owned(static_cast<function*>(context));
+			(*owned)();
+		};
+		void* const context = new function(std::forward<Func>(func));
+
+		mPending.fetch_add(1, std::memory_order_relaxed);
+
+		{
+			auto& queue = *mQueues[mNext++ % mQueues.size()];
+
+			std::lock_guard lock(queue.mutex);
+			queue.tasks.push_back(task{run, context, 0, 0, nullptr});
+		}
+		wake(false);
+	}
+
+      private:
+	[[nodiscard]] static std::size_t defaultWorkers() noexcept {
+#ifdef __EMSCRIPTEN__
+		return 0;
+#else
+		const std::size_t cores = std::thread::hardware_concurrency();
+
+		return cores > 1 ? cores - 1 : 0;
+#endif
+	}
+
+	void work(const std::size_t index) {
+		while (true) {
+			task t;
+			if (pop(index, t) || steal(index + 1, t)) {
+				execute(t);
+
+				continue;
+			}
+
+			std::unique_lock lock(mSleepMutex);
+			mWake.wait(lock, [this] { return mStop || mPending.load(std::memory_order_relaxed) != 0; });
+
+			if (mStop && mPending.load(std::memory_order_relaxed) == 0) {
+				return;
+			}
+		}
+	}
+
+	// Taking the mutex, even for nothing, orders this after a worker that checked `mPending` and is about to
+	// sleep, otherwise it could miss the notification
+	void wake(const bool all) {
+		{
+			std::lock_guard lock(mSleepMutex);
+		}
+
+		if (all) {
+			mWake.notify_all();
+		} else {
+			mWake.notify_one();
+		}
+	}
+
+	[[nodiscard]] bool pop(const std::size_t index, task& t) {
+		auto& queue = *mQueues[index];
+		std::lock_guard lock(queue.mutex);
+
+		if (queue.tasks.empty()) {
+			return false;
+		}
+
+		t = queue.tasks.front();
+		queue.tasks.pop_front();
+
+		return true;
+	}
+
+	// Looks through the other queues, starting at `first`, skipping the submitted tasks unless `submitted`
+	[[nodiscard]] bool steal(const std::size_t first, task& t, const bool submitted = true) {
+		for (std::size_t i = 0; i < mQueues.size(); ++i) {
+			auto& queue = *mQueues[(first + i) % mQueues.size()];
+			std::lock_guard lock(queue.mutex);
+
+			for (auto candidate = queue.tasks.rbegin(); candidate != queue.tasks.rend(); ++candidate) {
+				if (submitted || candidate->remaining != nullptr) {
+					t = *candidate;
+					queue.tasks.erase(std::next(candidate).base());
+
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	// Only the counter is touched here, the sleep mutex is left to the workers going to sleep
+	void execute(const task& t) {
+		mPending.fetch_sub(1, std::memory_order_relaxed);
+
+		t.run(t.context, t.begin, t.end);
+		if (t.remaining != nullptr) {
+			t.remaining->fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	std::vector<std::unique_ptr<task_queue>> mQueues;
+	std::vector<std::thread> mWorkers;
+	std::atomic<std::size_t> mNext;
+
+	// Number of tasks sitting in the queues, the workers sleep while it's 0
+	std::mutex mSleepMutex;
+	std::condition_variable mWake;
+	std::atomic<std::size_t> mPending = 0;
+	bool mStop = false;
+};
+
+} // namespace utils
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+namespace utils {
+
+// Dense IDs, one sequence per family, e.g. `utils::type_id<ComponentManager>::value<Components::block>`
+// They are handed out while the program starts, so reading one later is a plain load with no init guard
+template <typename Family> class type_id final {
+	inline static std::size_t sCounter = 0;
+
+      public:
+	template <typename Type> inline static const std::size_t value = sCounter++;
+};
+
+} // namespace utils
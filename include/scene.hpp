@@ -3,35 +3,34 @@
 #include "components.hpp"
 #include "managers/componentManager.hpp"
 #include "managers/entityManager.hpp"
+#include "managers/eventBus.hpp"
+#include "misc/snapshot.hpp"
+#include "misc/sparse_set_group.hpp"
 #include "misc/sparse_set_view.hpp"
+#include "misc/type_id.hpp"
 
+#include <SDL3/SDL.h>
 #include <SDL3/SDL_assert.h>
+#include <algorithm>
+#include <array>
+#include <cinttypes>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <span>
+#include <tuple>
 #include <unordered_map>
-
-// Cache is defined in utils.cpp
-extern std::vector<int*> mViewCache;
-
-template <typename... Components> [[nodiscard]] utils::sparse_set_view<Components...> view_impl() {
-	static int key = (mViewCache.push_back(&key), false);
-	static utils::sparse_set_view<Components...> view = utils::sparse_set_view<Components...>();
-
-	if (key) {
-		view = utils::sparse_set_view<Components...>();
-		key = false;
-	}
-
-	return view;
-}
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 class Scene {
-#ifdef IMGUI
-	// Needed for signal list menu
-	friend class SystemManager;
-#endif
       public:
-	Scene() noexcept : mEntityManager(new EntityManager()), mSignals() {}
+	Scene() noexcept
+		: mEntityManager(new EntityManager()), mComponentManager(new ComponentManager()), mEvents(),
+		  mViewCache(), mCommands() {}
 
 	Scene(Scene&&) = delete;
 	Scene(const Scene&) = delete;
@@ -39,57 +38,338 @@ class Scene {
 	Scene& operator=(const Scene&) = delete;
 
 	~Scene() noexcept {
+		delete mComponentManager;
 		delete mEntityManager;
-		markAllCachesDirty();
 	}
 
 	// This returns a UUID for a new entity
-	[[nodiscard]] EntityID newEntity() noexcept {
-		const EntityID entity = mEntityManager->getEntity();
-		markAllCachesDirty();
-		return entity;
+	[[nodiscard]] EntityID newEntity() noexcept { return mEntityManager->getEntity(); }
+
+	// Creates `count` entities at once
+	[[nodiscard]] std::vector<EntityID> createMany(const std::size_t count) {
+		std::vector<EntityID> entities;
+		mEntityManager->getEntities(count, entities);
+
+		return entities;
 	}
 
 	// Adds a component to an entity
 	template <typename Component, typename... Args> void emplace(const EntityID entity, Args&&... args) {
-		static auto* const pool = ComponentManager::getInstance()->getPool<Component>();
+		// The pool bumps its own version, only the views over it get rebuilt
+		(void)sPersistent<Component>;
+		mComponentManager->emplace<Component>(entity, std::forward<Args>(args)...);
+	}
+
+	// Adds the n-th value to the n-th entity, the pool grows once and views are only invalidated once
+	template <typename Component, typename Values>
+	void emplaceRange(const std::span<const EntityID> entities, Values&& values) {
+		(void)sPersistent<Component>;
+		mComponentManager->insert<Component>(entities, std::forward<Values>(values));
+	}
 
-		pool->emplace(entity, std::forward<Args>(args)...);
-		// Mark entire view cache as dirty because we changed the pools
-		markAllCachesDirty();
+	// Overwrites the entity's component and tells the `onReplace` listeners
+	template <typename Component, typename... Args> Component& replace(const EntityID entity, Args&&... args) {
+		return mComponentManager->replace<Component>(entity, std::forward<Args>(args)...);
+	}
+
+	// Calls `func(component)` and marks the component as changed, the `onReplace` listeners are told after
+	template <typename Component, typename Func> Component& patch(const EntityID entity, Func&& func) {
+		return mComponentManager->patch<Component>(entity, std::forward<Func>(func));
+	}
+
+	// `get` for writing, the component shows up in `changed` filters afterwards
+	template <typename Component> [[nodiscard]] Component& getMut(const EntityID entity) const {
+		return mComponentManager->getMut<Component>(entity);
+	}
+
+	// Change detection, a system keeps the tick of its last run and filters on what's newer:
+	// `const auto since = mLastRun; mLastRun = scene->advanceTick();`
+	// `for (const auto entity : scene->view<Components::position>().changed<Components::position>(since))`
+	[[nodiscard]] std::uint64_t tick() const noexcept { return mComponentManager->tick(); }
+	std::uint64_t advanceTick() noexcept { return mComponentManager->advanceTick(); }
+
+	// Lifecycle signals of a component pool, listeners are called with the entity and its component
+	// `scene->onConstruct<Components::block>().connect<&RenderSystem::blockAdded>(this)`
+	template <typename Component> [[nodiscard]] utils::signal<EntityID, Component&>& onConstruct() {
+		return mComponentManager->onConstruct<Component>();
+	}
+
+	template <typename Component> [[nodiscard]] utils::signal<EntityID, Component&>& onDestroy() {
+		return mComponentManager->onDestroy<Component>();
+	}
+
+	template <typename Component> [[nodiscard]] utils::signal<EntityID, Component&>& onReplace() {
+		return mComponentManager->onReplace<Component>();
 	}
 
 	template <typename Component> [[nodiscard]] Component& get(const EntityID entity) const {
-		return ComponentManager::getInstance()->getPool<Component>()->get(entity);
+		return mComponentManager->get<Component>(entity);
 	}
 
 	template <typename Component> [[nodiscard]] bool contains(const EntityID entity) const {
-		return ComponentManager::getInstance()->getPool<Component>()->contains(entity);
+		return mComponentManager->contains<Component>(entity);
 	}
 
-	template <typename... Components> [[nodiscard]] utils::sparse_set_view<Components...> view() {
-		return ::view_impl<Components...>();
+	// Iterates the storage in place, nothing is copied or allocated
+	// `scene->view<Components::position>(utils::exclude<Components::block>)` skips the entities with a block
+	// A `utils::lazy_view`, or a `utils::archetype_view` with the ARCHETYPE option
+	template <typename... Components, typename... Excludes>
+	[[nodiscard]] auto view(utils::exclude_t<Excludes...> = {}) const {
+		return mComponentManager->view<Components...>(utils::exclude_t<Excludes...>{});
 	}
 
-	// Remove an entity
+	// A materialized list of the entities, rebuilt only when one of the pools changed
+	// Cheaper than `view` when the same set is walked many times per frame, but the entities must not be erased
+	// while iterating over it
+	template <typename... Components> [[nodiscard]] const utils::sparse_set_view<Components...>& cachedView() {
+		const std::array<std::uint64_t, sizeof...(Components)> current = {
+			mComponentManager->version<Components>()...};
+		const std::size_t id = utils::type_id<Scene>::value<utils::sparse_set_view<Components...>>;
+
+		if (id >= mViewCache.size()) {
+			mViewCache.resize(id + 1);
+		}
+
+		auto* cache = static_cast<CachedView<Components...>*>(mViewCache[id].get());
+		if (cache == nullptr) {
+			mViewCache[id] = std::make_unique<CachedView<Components...>>(mComponentManager, current);
+			cache = static_cast<CachedView<Components...>*>(mViewCache[id].get());
+		} else if (cache->mVersions != current) {
+			// Each cached view remembers the versions of its own pools, only those invalidate it
+			cache->mView = utils::sparse_set_view<Components...>(mComponentManager);
+			cache->mVersions = current;
+		}
+
+		return cache->mView;
+	}
+
+	// Owning group, the owned pools keep the entities with all the components packed at the front in the same order
+	// The group is created on the first call and kept up to date from then on, a component can only be owned once
+	// With the ARCHETYPE option the tables are packed already, and this is a view
+	template <typename... Owned> [[nodiscard]] auto group() { return mComponentManager->group<Owned...>(); }
+
+	// Remove an entity, stale handles are ignored
 	void erase(const EntityID entity) noexcept {
 		SDL_assert(entity != 0);
-		ComponentManager::getInstance()->erase(entity);
+		if (!mEntityManager->valid(entity)) {
+			return;
+		}
+
+		mComponentManager->erase(entity);
 		mEntityManager->releaseEntity(entity);
+	}
+
+	// Like `erase` for each entity, but the components are erased a pool at a time
+	void eraseRange(const std::span<const EntityID> entities) {
+		std::vector<EntityID> alive;
+		alive.reserve(entities.size());
+		for (const auto entity : entities) {
+			SDL_assert(entity != 0);
+			if (mEntityManager->valid(entity)) {
+				alive.emplace_back(entity);
+			}
+		}
+
+		mComponentManager->erase(alive);
+
+		// Listed twice is released once
+		for (const auto entity : alive) {
+			if (mEntityManager->valid(entity)) {
+				mEntityManager->releaseEntity(entity);
+			}
+		}
+	}
+
+	// Erases every entity with the component for which `predicate(entity, component)` is true
+	template <typename Component, typename Func> void eraseIf(Func predicate) {
+		std::vector<EntityID> erased;
+		for (const auto& [entity, component] : view<Component>().each()) {
+			if (predicate(entity, std::as_const(component))) {
+				erased.emplace_back(entity);
+			}
+		}
+
+		eraseRange(erased);
+	}
+
+	// Structural changes recorded while iterating, applied in order by `flush`
+	// The ID is handed out right away, so later commands and components can refer to it
+	template <typename Component, typename... Args> void deferEmplace(const EntityID entity, Args&&... args) {
+		mCommands.emplace_back([entity, ... args = std::forward<Args>(args)](Scene* scene) mutable {
+			scene->emplace<Component>(entity, std::move(args)...);
+		});
+	}
 
-		markAllCachesDirty();
+	void deferErase(const EntityID entity) {
+		mCommands.emplace_back([entity](Scene* scene) { scene->erase(entity); });
 	}
 
-	[[nodiscard]] bool valid(const EntityID entity) noexcept { return mEntityManager->valid(entity); }
+	// The sync point, called once the systems are done iterating
+	// Commands recorded while flushing are applied too
+	void flush() {
+		while (!mCommands.empty()) {
+			std::vector<std::function<void(Scene*)>> commands;
+			commands.swap(mCommands);
 
-	[[nodiscard]] std::int64_t& getSignal(const std::uint64_t signal) noexcept {
-		if (!mSignals.contains(signal)) {
-			mSignals[signal] = false;
+			for (auto& command : commands) {
+				command(this);
+			}
 		}
-		return mSignals[signal];
 	}
 
-	void clearSignals() noexcept { mSignals.clear(); }
+	// A binary copy of the entities and of every persistent component (`utils::persistent`), for quicksaves, test
+	// fixtures and rollback. A header and the entity generations come first, then a table of the component types,
+	// then each pool as one block of packed entities followed by one block of packed components
+	// Components that aren't persistent, like textures, aren't in it and have to be added back after loading
+	[[nodiscard]] std::vector<std::byte> saveSnapshot() const {
+		std::vector<const PersistentComponent*> pools;
+		std::size_t bytes = 0;
+		for (const auto& [hash, component] : persistentComponents()) {
+			const std::size_t size = component.count(*mComponentManager);
+			if (size != 0) {
+				pools.emplace_back(&component);
+				bytes += size * (sizeof(EntityID) + component.size);
+			}
+		}
+
+		utils::snapshot_writer writer;
+		writer.reserve(bytes + pools.size() * 3 * sizeof(std::uint64_t) + 64);
+
+		writer.write(SNAPSHOT_MAGIC);
+		writer.write(SNAPSHOT_VERSION);
+		mEntityManager->save(writer);
+
+		writer.write(static_cast<std::uint64_t>(pools.size()));
+		for (const auto* const pool : pools) {
+			writer.write(pool->hash);
+			writer.write(pool->size);
+			writer.write(static_cast<std::uint64_t>(pool->count(*mComponentManager)));
+		}
+
+		for (const auto* const pool : pools) {
+			pool->save(*mComponentManager, writer);
+		}
+
+		return writer.release();
+	}
+
+	// Replaces every entity and component with the ones in the snapshot, the destroy and construct listeners are
+	// told as usual. Component types this build doesn't know are skipped
+	// Returns false, and leaves the scene empty, if the snapshot is broken or from another version
+	// Deferred commands are dropped, they were meant for the entities being replaced
+	[[nodiscard]] bool loadSnapshot(const std::span<const std::byte> data) {
+		mCommands.clear();
+		mComponentManager->clear();
+
+		const auto fail = [this](const char* const reason) {
+			SDL_Log("\033[31mScene: Can't load snapshot, %s\033[0m", reason);
+
+			mComponentManager->clear();
+			delete mEntityManager;
+			mEntityManager = new EntityManager();
+
+			return false;
+		};
+
+		utils::snapshot_reader reader(data);
+		std::uint32_t magic = 0;
+		std::uint32_t version = 0;
+		if (!reader.read(magic) || !reader.read(version) || magic != SNAPSHOT_MAGIC) {
+			return fail("not a snapshot");
+		}
+
+		if (version != SNAPSHOT_VERSION) {
+			return fail("made by another version");
+		}
+
+		if (!mEntityManager->restore(reader)) {
+			return fail("broken entity table");
+		}
+
+		struct Pool {
+			const PersistentComponent* component;
+			std::uint64_t size;
+			std::uint64_t count;
+		};
+
+		std::uint64_t count = 0;
+		if (!reader.read(count)) {
+			return fail("truncated");
+		}
+
+		std::vector<Pool> pools;
+		std::unordered_set<std::uint64_t> hashes;
+		for (std::uint64_t i = 0; i < count; ++i) {
+			std::uint64_t hash = 0;
+			Pool pool{nullptr, 0, 0};
+			if (!reader.read(hash) || !reader.read(pool.size) || !reader.read(pool.count)) {
+				return fail("truncated");
+			}
+
+			// Anything bigger can't be in the data, and would overflow the sizes below
+			if (pool.count > data.size() || (pool.size != 0 && pool.count > data.size() / pool.size)) {
+				return fail("broken type table");
+			}
+
+			if (!hashes.insert(hash).second) {
+				return fail("component listed twice");
+			}
+
+			const auto component = persistentComponents().find(hash);
+			if (component == persistentComponents().end()) {
+				SDL_Log("\033[93mScene: Skipping unknown component %" PRIx64 "\033[0m", hash);
+			} else if (component->second.size != pool.size) {
+				SDL_Log("\033[93mScene: Skipping component %" PRIx64 ", its size changed\033[0m", hash);
+			} else {
+				pool.component = &component->second;
+			}
+
+			pools.emplace_back(pool);
+		}
+
+		std::vector<EntityID> entities;
+		std::vector<EntityID> sorted;
+		for (const auto& pool : pools) {
+			const std::byte* const packed = reader.bytes(pool.count * sizeof(EntityID));
+			const std::byte* const values = reader.bytes(pool.count * pool.size);
+			if (packed == nullptr || values == nullptr) {
+				return fail("truncated");
+			}
+
+			if (pool.component == nullptr) {
+				continue;
+			}
+
+			entities.resize(pool.count);
+			std::memcpy(entities.data(), packed, pool.count * sizeof(EntityID));
+
+			for (const auto entity : entities) {
+				if (!mEntityManager->valid(entity)) {
+					return fail("component of a dead entity");
+				}
+			}
+
+			sorted = entities;
+			std::ranges::sort(sorted);
+			if (std::ranges::adjacent_find(sorted) != sorted.end()) {
+				return fail("entity listed twice in a pool");
+			}
+
+			pool.component->restore(*mComponentManager, entities, values);
+		}
+
+		if (!reader.done()) {
+			return fail("trailing data");
+		}
+
+		return true;
+	}
+
+	// O(1), false for the null entity and for handles whose entity has been erased
+	[[nodiscard]] bool valid(const EntityID entity) const noexcept { return mEntityManager->valid(entity); }
+
+	// Keys, mouse and the other signals the systems react to
+	[[nodiscard]] EventBus& events() noexcept { return mEvents; }
 
 	// A structure used e.g. for the mouse
 	struct {
@@ -98,14 +378,71 @@ class Scene {
 	} mMouse;
 
       private:
-	// Mark entire view cache as dirty, because any change in the pools invalidates all cached views
-	void markAllCachesDirty() {
-		for (int* const cachePtr : mViewCache) {
-			*cachePtr = true;
+	// "ECSS"
+	constexpr const static inline std::uint32_t SNAPSHOT_MAGIC = 0x53534345;
+	// Bump whenever the layout changes
+	constexpr const static inline std::uint32_t SNAPSHOT_VERSION = 1;
+
+	// How to save and restore one persistent component type, without knowing the type
+	struct PersistentComponent {
+		std::uint64_t hash;
+		// Bytes per component, 0 for tags
+		std::uint64_t size;
+		std::size_t (*count)(const ComponentManager& manager);
+		void (*save)(const ComponentManager& manager, utils::snapshot_writer& writer);
+		void (*restore)(ComponentManager& manager, std::span<const EntityID> entities, const std::byte* values);
+	};
+
+	// By `utils::type_hash`. Filled while the program starts, with every type that is emplaced somewhere, so a new
+	// scene can restore pools it hasn't made yet
+	[[nodiscard]] static std::unordered_map<std::uint64_t, PersistentComponent>& persistentComponents() {
+		static std::unordered_map<std::uint64_t, PersistentComponent> components;
+
+		return components;
+	}
+
+	template <typename Component> static bool persist() {
+		if constexpr (utils::persistent<Component>) {
+			constexpr const std::uint64_t hash = utils::type_hash<Component>();
+			SDL_assert(!persistentComponents().contains(hash) && "Two components with the same type hash");
+
+			persistentComponents().emplace(
+				hash,
+				PersistentComponent{
+					hash, std::is_empty_v<Component> ? 0 : sizeof(Component),
+					[](const ComponentManager& manager) { return manager.size<Component>(); },
+					[](const ComponentManager& manager, utils::snapshot_writer& writer) {
+						manager.savePool<Component>(writer);
+					},
+					[](ComponentManager& manager, const std::span<const EntityID> entities,
+					   const std::byte* const values) {
+						manager.restorePool<Component>(entities, values);
+					}});
 		}
+
+		return true;
 	}
 
+	template <typename Component> inline static const bool sPersistent = persist<Component>();
+
+	struct CachedViewInterface {
+		virtual ~CachedViewInterface() = default;
+	};
+
+	template <typename... Components> struct CachedView final : CachedViewInterface {
+		CachedView(ComponentManager* componentManager,
+			   const std::array<std::uint64_t, sizeof...(Components)>& versions)
+			: mVersions(versions), mView(componentManager) {}
+
+		std::array<std::uint64_t, sizeof...(Components)> mVersions;
+		utils::sparse_set_view<Components...> mView;
+	};
+
 	class EntityManager* mEntityManager;
+	class ComponentManager* mComponentManager;
 
-	std::unordered_map<std::uint64_t, std::int64_t> mSignals;
+	EventBus mEvents;
+	// Indexed by the type ID of the view
+	std::vector<std::unique_ptr<CachedViewInterface>> mViewCache;
+	std::vector<std::function<void(Scene*)>> mCommands;
 };
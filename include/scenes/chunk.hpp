@@ -1,20 +1,37 @@
 #pragma once
 
 #include "components.hpp"
+#include "misc/snapshot.hpp"
 #include "third_party/rapidjson/document.h"
 
+#include <SDL3/SDL.h>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
 
+// The terrain of a chunk, one block ID per cell
+// Blocks don't get entities, the systems read the grid through the level
 class Chunk {
       public:
 	inline constexpr const static int MAX_HEIGHT = 128;
 	inline constexpr const static int CHUNK_WIDTH = 16;
 	inline constexpr const static int WATER_LEVEL = 16;
+	// How far the surface goes above and below the water level
+	inline constexpr const static int HILL_HEIGHT = 8;
+
+	// The height of the grass block of a column
+	[[nodiscard]] static std::uint64_t surfaceOf(const class NoiseGenerator* const noise, const std::int64_t x);
 
 	// Generate a chunk from scratch
-	explicit Chunk(class Scene* scene, class NoiseGenerator* const noise, const std::int64_t position);
-	// Load from json
-	explicit Chunk(const rapidjson::Value& data, class Scene* scene);
+	explicit Chunk(const class NoiseGenerator* const noise, const std::int64_t position);
+	// Load from the json of the saves before region files
+	explicit Chunk(const rapidjson::Value& data);
+	// Load what `save` wrote, null if the data is broken
+	[[nodiscard]] static std::unique_ptr<Chunk> load(const std::span<const std::byte> data);
 
 	Chunk(Chunk&&) = delete;
 	Chunk(const Chunk&) = delete;
@@ -22,21 +39,76 @@ class Chunk {
 	Chunk& operator=(const Chunk&) = delete;
 	~Chunk() = default;
 
-	void save(class Scene* scene, rapidjson::Value& chunk, rapidjson::MemoryPoolAllocator<>& allocator);
+	// For the region files and the unloaded chunks: the position, a palette of the types in the chunk, and the runs
+	// of one type column by column, as their lengths and then their palette indices packed in as few bits as fit
+	void save(utils::snapshot_writer& writer) const;
 
 	[[nodiscard]] std::int64_t getPosition() const { return mPosition; }
 
+	// Changed since it was last written to its region, a generated chunk never was
+	[[nodiscard]] bool dirty() const { return mDirty; }
+	void setDirty(const bool dirty) { mDirty = dirty; }
+
+	// The chunk a block column is in
+	[[nodiscard]] static std::int64_t chunkOf(const std::int64_t x) {
+		return x / CHUNK_WIDTH - (x < 0 && x % CHUNK_WIDTH != 0);
+	}
+
+	// Positions are in blocks, in world space
+	[[nodiscard]] bool contains(const Eigen::Vector2i& position) const {
+		return chunkOf(position.x()) == mPosition && position.y() >= 0 && position.y() < MAX_HEIGHT;
+	}
+	[[nodiscard]] Components::Item getBlock(const Eigen::Vector2i& position) const {
+		return contains(position) ? static_cast<Components::Item>(mTiles[index(position)]) : Components::Item{};
+	}
+	void setBlock(const Eigen::Vector2i& position, const Components::Item type) {
+		SDL_assert(contains(position));
+
+		mTiles[index(position)] = static_cast<tile>(type);
+	}
+
+	// Calls `function(position, type)` for every block that isn't air, column by column
+	template <typename Function> void each(Function&& function) const {
+		for (int x = 0; x < CHUNK_WIDTH; ++x) {
+			for (int y = 0; y < MAX_HEIGHT; ++y) {
+				if (const tile type = mTiles[x * MAX_HEIGHT + y]; type != 0) {
+					function(Eigen::Vector2i(mPosition * CHUNK_WIDTH + x, y),
+						 static_cast<Components::Item>(type));
+				}
+			}
+		}
+	}
+
       private:
+	// Item IDs are small, 16 bits keeps a chunk at 4 KiB
+	using tile = std::uint16_t;
+
 	constexpr const static inline char* const POSITION_KEY = "position";
 	constexpr const static inline char* const BLOCKS_KEY = "blocks";
-	constexpr const static inline char* const ITEMS_KEY = "items";
+	// Bumped when the binary layout changes
+	// The palette and the runs of one type, the raw grid before that is still read
+	constexpr const static inline std::uint8_t FORMAT = 2;
+	constexpr const static inline std::uint8_t RAW_FORMAT = 1;
+
+	// An empty chunk, filled by `load`
+	explicit Chunk(const std::int64_t position) : mPosition(position), mDirty(false), mHeightMap(), mTiles() {}
 
-	void spawnStructure(std::vector<std::vector<Components::Item>>& blocks, const Eigen::Vector2i& pos,
-			    const std::vector<std::pair<Components::Item, Eigen::Vector2i>> structure,
-			    class Scene* scene);
-	void carve(std::vector<std::vector<Components::Item>>& blocks, class NoiseGenerator* const noise);
-	void spawnOres(std::vector<std::vector<Components::Item>>& blocks, class NoiseGenerator* const noise);
+	[[nodiscard]] std::size_t index(const Eigen::Vector2i& position) const {
+		return static_cast<std::size_t>(position.x() - mPosition * CHUNK_WIDTH) * MAX_HEIGHT + position.y();
+	}
+	// Chunk relative access for the generator
+	[[nodiscard]] tile& at(const int x, const int y) { return mTiles[x * MAX_HEIGHT + y]; }
+
+	// `pos` is chunk relative and may be out of it, only the blocks that land in the chunk are placed
+	void spawnStructure(const Eigen::Vector2i& pos,
+			    const std::vector<std::pair<Components::Item, Eigen::Vector2i>>& structure);
+	void carve(const class NoiseGenerator* const noise);
+	void spawnOres(const class NoiseGenerator* const noise);
 
 	const std::int64_t mPosition;
+	bool mDirty;
 	std::array<std::uint64_t, CHUNK_WIDTH> mHeightMap;
+
+	// Indexed by x and then y, 0 is air
+	std::array<tile, CHUNK_WIDTH * MAX_HEIGHT> mTiles;
 };
@@ -1,11 +1,24 @@
 #pragma once
 
+#include "items.hpp"
 #include "managers/entityManager.hpp"
+#include "misc/lru_cache.hpp"
+#include "scenes/chunk.hpp"
+#include "scenes/region.hpp"
+#include "third_party/Eigen/Core"
 #include "third_party/rapidjson/document.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 // Something important
 class Level {
@@ -20,34 +33,189 @@ class Level {
 	void create();
 	void load(rapidjson::Value& data);
 	void save(rapidjson::Value& data, rapidjson::MemoryPoolAllocator<>& allocator);
+	// Once the saved data of a new level is written, the regions of the world it replaced aren't needed anymore
+	void dropOldRegions();
 
 	std::string getName() const { return mName; }
     class Scene* getScene() const { return mScene.get(); };
 
 	// The update method maily checks if new chunks needs to be loaded
 	void update(float delta);
-	std::int64_t getPosition();
+	// The chunk the player is in
+	[[nodiscard]] std::int64_t getPosition() const { return mCenter; }
+
+	// How many chunks on each side of the player are drawn, and how many have their entities simulated
+	// The render radius is raised to what the window shows, the loaded chunks cover both
+	void setRadius(const std::int64_t render, const std::int64_t simulation);
+	[[nodiscard]] std::int64_t getRenderRadius() const { return mRenderRadius; }
+	[[nodiscard]] std::int64_t getSimulationRadius() const { return mSimulationRadius; }
+	// If the entities at that position, in pixels, move
+	[[nodiscard]] bool simulated(const Eigen::Vector2f& position) const {
+		return std::llabs(chunkOf(position.x()) - mCenter) <= mSimulationRadius;
+	}
+
+	// The terrain of the loaded chunks, positions are in blocks
+	// Air when the chunk isn't loaded
+	[[nodiscard]] Components::Item blockAt(const Eigen::Vector2i& position) const;
+	// Returns false if the chunk isn't loaded
+	bool setBlock(const Eigen::Vector2i& position, const Components::Item type);
+	// Calls `function(position, type)` for the blocks in the rectangle, corners included
+	// Air and the columns that aren't loaded are skipped
+	template <typename Function>
+	void eachBlock(const Eigen::Vector2i& min, const Eigen::Vector2i& max, Function&& function) const {
+		const int bottom = std::max(min.y(), 0);
+		const int top = std::min(max.y(), Chunk::MAX_HEIGHT - 1);
+
+		for (int x = min.x(); x <= max.x(); ++x) {
+			const Chunk* const chunk = getChunk(x);
+			if (chunk == nullptr) {
+				continue;
+			}
+
+			for (int y = bottom; y <= top; ++y) {
+				const Eigen::Vector2i position(x, y);
+
+				if (const auto type = chunk->getBlock(position); type != Components::Item::AIR) {
+					function(position, type);
+				}
+			}
+		}
+	}
+	// How the chunks that got loaded were found
+	struct prefetch_stats {
+		// Already decoded: prefetched, finished by the workers or still in the cache
+		std::uint64_t hits;
+		// Parsed or generated on the spot, the frame waited for them
+		std::uint64_t misses;
+		// Requests dropped before they were needed, the player turned around
+		std::uint64_t cancelled;
+	};
+	[[nodiscard]] const prefetch_stats& getPrefetchStats() const { return mStats; }
+
+	// Changes whenever a block is set or the loaded chunks move, for the systems caching the terrain
+	[[nodiscard]] std::uint64_t getRevision() const { return mRevision; }
+	// Calls `function(chunk)` for the chunks within the render radius, left to right
+	template <typename Function> void eachRenderedChunk(Function&& function) const {
+		for (std::int64_t position = mCenter - mRendered; position <= mCenter + mRendered; ++position) {
+			if (const auto chunk = mChunks.find(position); chunk != mChunks.end()) {
+				function(static_cast<const Chunk&>(*chunk->second));
+			}
+		}
+	}
 
       private:
 	inline constexpr const static char* const CHUNK_KEY = "chunks";
 	inline constexpr const static char* const PLAYER_KEY = "player";
+	inline constexpr const static char* const REGIONS_KEY = "regions";
 	inline constexpr const static uint64_t ROLL_TIME = 5000;
+	inline constexpr const static std::int64_t RENDER_RADIUS = 1;
+	inline constexpr const static std::int64_t SIMULATION_RADIUS = 1;
+	// How much the unloaded chunks kept around take at most, a few thousand chunks once encoded
+	inline constexpr const static std::size_t CACHE_BUDGET = 2 * 1024 * 1024;
+	// How many chunks past the loaded ones are generated ahead of time, even standing still
+	inline constexpr const static std::int64_t PREFETCH_DISTANCE = 1;
+	// How far ahead the player's movement is followed, in seconds
+	inline constexpr const static float PREFETCH_TIME = 2.0f;
+	// The speed used for the chunks the player isn't moving towards, about a third of walking
+	inline constexpr const static float PREFETCH_DRIFT = 100.0f;
+	// How many chunks can be generating at once, and how many saved ones are decoded each frame
+	inline constexpr const static std::size_t PREFETCH_JOBS = 4;
+	inline constexpr const static std::size_t PREFETCH_LOADS = 1;
+
+	// An unloaded chunk, encoded like in the region files
+	struct unloaded {
+		std::vector<std::byte> data;
+		bool dirty;
+	};
 
 	void createCommon();
+	// Null if the chunk holding the column isn't loaded
+	[[nodiscard]] Chunk* getChunk(const std::int64_t x) const;
+	// The chunk an entity is in, from its x in pixels
+	[[nodiscard]] static std::int64_t chunkOf(const float x);
+
+	// The region file holding the chunk, opened the first time it's needed
+	[[nodiscard]] Region& region(const std::int64_t position);
+	[[nodiscard]] bool saved(const std::int64_t position) { return region(position).contains(position); }
+	// Null if the chunk was never saved, or the save is broken
+	[[nodiscard]] std::unique_ptr<Chunk> readChunk(const std::int64_t position);
+	[[nodiscard]] static std::vector<std::byte> encode(const Chunk& chunk);
+	// Null if the data is broken
+	[[nodiscard]] static std::unique_ptr<Chunk> decode(const std::int64_t position,
+							   const std::span<const std::byte> data);
+	// Saves from before the region files have the chunks in the level data, they are moved out
+	void migrate();
+	// The chunks needed to fill the window on each side of the player
+	[[nodiscard]] std::int64_t windowRadius() const;
+	// Moves the loaded chunks to the radius around `center`, only the ones that left it or came in are touched
+	void shift(const std::int64_t center);
+	// Takes the chunk from the unloaded ones, or loads it from the save, or takes it from the workers, or
+	// generates it, and indexes it
+	Chunk* loadChunk(const std::int64_t position);
+	// Takes the chunk out of the index and keeps it with the unloaded ones
+	void unloadChunk(const std::int64_t position);
+	// Keeps the encoded chunk with the unloaded ones, storing the oldest if they go over the budget
+	// A chunk that isn't dirty is the same as in its region file already
+	void cache(const std::int64_t position, std::vector<std::byte> data, const bool dirty);
+	// Writes the encoded chunk to its region file
+	void store(const std::int64_t position, const std::span<const std::byte> data);
+	// Stores an unloaded chunk that leaves the cache, unless it wasn't changed since it was read
+	void evict(const std::int64_t position, const unloaded& chunk);
+	// Generates a chunk right away, for when the workers didn't get to it
+	// Chunks place the structures growing in from their neighbours themselves, so nothing else is touched
+	[[nodiscard]] std::unique_ptr<Chunk> generate(const std::int64_t position);
+
+	// Gets the chunks the player will reach in the next `PREFETCH_TIME` seconds ready, the soonest first
+	// Saved ones are decoded into the cache, the others are generated by the workers
+	// The requests that fell out of reach are cancelled
+	void prefetch();
+	// Queues a chunk on the thread pool
+	void request(const std::int64_t position);
+	// Takes the chunks the workers finished
+	void collect();
+	// Taken from a counter shared by all levels, so a new level never reports an old revision
+	void changed() { mRevision = ++sRevision; }
 
 	const std::string mName;
 	EntityID mTextID;
 	uint64_t mLastTime;
 
+	// The seed and the player, the chunks are in the region files
 	rapidjson::Document mData;
+	// Each created level has a directory of its own in the world one, the old world's stays until this one is saved
+	std::string mRegionPath;
+	bool mFresh;
+	std::unordered_map<std::int64_t, std::unique_ptr<Region>> mRegions;
 
-	// We only need three chunks max loaded at once
-	class Chunk* mLeft;
-	class Chunk* mCenter;
-	class Chunk* mRight;
+	// The loaded chunks are the ones within `mRadius` of `mCenter`, by position
+	std::unordered_map<std::int64_t, std::unique_ptr<Chunk>> mChunks;
+	std::int64_t mCenter;
+	std::int64_t mRenderRadius;
+	std::int64_t mSimulationRadius;
+	// The render radius once raised to the window, and the larger of it and the simulation one
+	std::int64_t mRendered;
+	std::int64_t mRadius;
+	// Recently unloaded chunks, encoded like in the region files, the dirty ones are written as is once evicted
+	utils::lru_cache<std::int64_t, unloaded> mUnloaded;
 
 	class Game* mGame;
     std::unique_ptr<Scene> mScene;
 
 	std::unique_ptr<class NoiseGenerator> mNoise;
+
+	// Filled by the workers, emptied by `collect`
+	// The jobs share it, so the level can go away while they still run
+	struct generated {
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Chunk>> chunks;
+	};
+	std::shared_ptr<generated> mGenerated;
+	// Chunks the workers are on with their cancel flag, and the ones they finished that aren't loaded yet
+	std::unordered_map<std::int64_t, std::shared_ptr<std::atomic<bool>>> mRequested;
+	std::unordered_map<std::int64_t, std::unique_ptr<Chunk>> mReady;
+
+	prefetch_stats mStats;
+
+	inline static std::uint64_t sRevision = 0;
+	std::uint64_t mRevision;
 };
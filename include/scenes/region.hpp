@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// A file holding the saved chunks of `REGION_WIDTH` neighbouring chunks, so saving a chunk only writes its own sectors
+// The first sector is the header: a magic, a version, and for every chunk where it is as (first sector, sectors,
+// bytes), little endian. A chunk that was never saved has no bytes
+// Chunks are rewritten in place while they fit, otherwise they go in the first free run of sectors
+// Reads go through a read only memory map where the platform has one
+// The file is opened read only, and only reopened for writing, or created, by the first write
+class Region {
+      public:
+	inline constexpr const static std::int64_t REGION_WIDTH = 32;
+	inline constexpr const static std::uint64_t SECTOR_SIZE = 4096;
+
+	// Opens the file if there is one, a missing file is an empty region
+	explicit Region(const std::string& path);
+	Region(Region&&) = delete;
+	Region(const Region&) = delete;
+	Region& operator=(Region&&) = delete;
+	Region& operator=(const Region&) = delete;
+	~Region();
+
+	// The region a chunk is in
+	[[nodiscard]] static std::int64_t regionOf(const std::int64_t chunk) {
+		return chunk / REGION_WIDTH - (chunk < 0 && chunk % REGION_WIDTH != 0);
+	}
+	// Where the file of a region goes in the world directory
+	[[nodiscard]] static std::string pathOf(const std::string& directory, const std::int64_t region);
+	// Deletes the region files in the directory, once the world they belong to was replaced
+	static void removeAll(const std::string& directory);
+
+	// False if the file is there but couldn't be opened or isn't a region file, nothing is read or written then
+	[[nodiscard]] bool valid() const { return !mBroken; }
+	[[nodiscard]] bool contains(const std::int64_t chunk) const { return mEntries[slot(chunk)].size != 0; }
+
+	// The saved bytes of the chunk, empty if there are none. Only valid until the next write
+	[[nodiscard]] std::span<const std::byte> read(const std::int64_t chunk);
+	// Returns false if the file couldn't be written, the first write creates it
+	bool write(const std::int64_t chunk, const std::span<const std::byte> data);
+
+      private:
+	// "2DRG"
+	inline constexpr const static std::uint32_t MAGIC = 0x47524432;
+	inline constexpr const static std::uint32_t VERSION = 1;
+	// The magic and the version come before the entries
+	inline constexpr const static std::uint64_t ENTRIES_OFFSET = 8;
+
+	struct entry {
+		std::uint32_t sector;
+		std::uint32_t sectors;
+		std::uint32_t size;
+	};
+
+	[[nodiscard]] static std::size_t slot(const std::int64_t chunk) {
+		return static_cast<std::size_t>(chunk - regionOf(chunk) * REGION_WIDTH);
+	}
+
+	[[nodiscard]] bool create();
+	// Reopens the file for writing, or creates it
+	[[nodiscard]] bool writable();
+	[[nodiscard]] bool readHeader();
+	[[nodiscard]] bool writeEntry(const std::size_t slot);
+	// The first run of `sectors` free sectors, past the end of the file if there is none
+	[[nodiscard]] std::uint32_t allocate(const std::size_t slot, const std::uint32_t sectors) const;
+
+	void map();
+	void unmap();
+
+	const std::string mPath;
+	// Null while there is no file
+	struct SDL_IOStream* mFile;
+	bool mWritable;
+	// The file is there but couldn't be read, it's left as is rather than overwritten
+	bool mBroken;
+	std::array<entry, REGION_WIDTH> mEntries;
+	// The length of the file, in sectors
+	std::uint32_t mSectors;
+
+	// The whole file when mapped, otherwise the chunk read last is copied in the buffer
+	const std::byte* mMapping;
+	std::size_t mMappingSize;
+	std::vector<std::byte> mBuffer;
+};
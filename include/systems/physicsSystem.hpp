@@ -1,14 +1,17 @@
 #pragma once
 
 #include "managers/entityManager.hpp"
-#include "opengl/shader.hpp"
+#include "items.hpp"
+#include "managers/eventBus.hpp"
+#include "third_party/Eigen/Core"
 
 #include <cstdint>
 #include <unordered_map>
+#include <utility>
 
 class PhysicsSystem {
       public:
-	constexpr const static inline std::uint64_t PHYSICS_DIRTY_SIGNAL = "physics_dirty"_u;
+	constexpr const static inline auto PHYSICS_DIRTY_SIGNAL = EventBus::Signal::PHYSICS_DIRTY;
 
 	explicit PhysicsSystem() noexcept;
 	PhysicsSystem(PhysicsSystem&&) = delete;
@@ -24,18 +27,33 @@ class PhysicsSystem {
 	constexpr const static inline std::uint64_t PICK_UP_RANGE = 150;
 	constexpr const static inline std::uint64_t PICK_UP_RANGE_SQ = PICK_UP_RANGE * PICK_UP_RANGE;
 
-	// Collision tests
-	bool AABBxAABB(const class Scene* scene, const EntityID entity, const EntityID block) const;
-	bool collidingBellow(const class Scene* scene, const EntityID entity, const EntityID block) const;
-	void pushBack(class Scene* scene, const EntityID entity, EntityID block);
+	// Offset and size of a block's collision box, in pixels
+	using box = std::pair<Eigen::Vector2f, Eigen::Vector2f>;
+
+	// Collision tests against the block at `block`, in block coordinates
+	bool AABBxAABB(const class Scene* scene, const EntityID entity, const Eigen::Vector2i& block,
+		       const box& blockCollision) const;
+	bool collidingBellow(const class Scene* scene, const EntityID entity, const Eigen::Vector2i& block,
+			     const box& blockCollision) const;
+	void pushBack(class Scene* scene, const EntityID entity, const Eigen::Vector2i& block,
+		      const box& blockCollision);
 	// Manages the falling and picking of items
 	void itemPhysics(class Scene* scene);
 
+	// Null for blocks you walk through
+	[[nodiscard]] static const box* tileCollision(const Components::Item type);
+	// Calls `function(block, box)` for the solid blocks touching the rectangle, in pixels
+	template <typename Function>
+	void eachTile(const Eigen::Vector2f& min, const Eigen::Vector2f& max, Function&& function) const;
+
 	class Game* mGame;
 
 	// Collision cache
 	struct {
-		std::unordered_map<EntityID, EntityID> lastAbove;
-		std::array<std::array<EntityID, 16 * 3>, 128> chunk;
+		std::unordered_map<EntityID, bool> onGround;
+
+		// Tick of the last `collide`, and the terrain it saw
+		std::uint64_t lastCollide = 0;
+		std::uint64_t revision = 0;
 	} mCache;
 };
@@ -1,8 +1,13 @@
 #pragma once
 
+#include "items.hpp"
+
 #include <SDL3/SDL_video.h>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 // TODO: DPI
 class RenderSystem {
@@ -34,8 +39,21 @@ class RenderSystem {
 	void setPersp() const;
 	void drawHUD(class Scene* scene);
 
+	// Rebuilds the instance data from the loaded chunks when the terrain changed
+	void updateBlocks();
+
 	class Game* mGame;
 
+	// Per block instance data, x, y and type, uploaded again only when dirty
+	struct {
+		std::vector<int> data;
+		// The level revision the data was built from
+		std::uint64_t revision = 0;
+		// Block types that might not be on the atlas yet
+		std::vector<Components::Item> blitz;
+		bool dirty = true;
+	} mBlocks;
+
 	// These are pointers managed by RenderSystem
 	std::unique_ptr<struct SDL_Window, void (*)(SDL_Window*)> mWindow;
 	std::unique_ptr<struct SDL_Cursor, void (*)(SDL_Cursor*)> mCursor;
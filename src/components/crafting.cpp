@@ -99,9 +99,9 @@ bool CraftingInventory::update(class Scene* const scene, const float delta) {
 		static std::int64_t lastClickPos;
 		const int slot =
 			static_cast<int>((mouseX - ox) / slotx) + static_cast<int>((mouseY - oy) / sloty) * mCols;
-		if (scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL)) {
+		if (scene->events().peek(EventManager::LEFT_CLICK_EVENT)) {
 			if ((mCraftingCount[slot] == 0 && scene->mMouse.count != 0 && lastClickPos == slot &&
-			     (scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL) - lastClick) < 300ul)) {
+			     (scene->events().peek(EventManager::LEFT_CLICK_EVENT) - lastClick) < 300ul)) {
 				SDL_assert(scene->mMouse.item != Components::AIR());
 
 				// Here we get all stuff together
@@ -118,7 +118,7 @@ bool CraftingInventory::update(class Scene* const scene, const float delta) {
 					}
 				}
 
-				scene->getSignal(DOUBLE_CLICK_SIGNAL) = false;
+				scene->events().consume(DOUBLE_CLICK_EVENT);
 				return;
 			}
 			// Normalize the buttons to grid cords
@@ -136,8 +136,8 @@ bool CraftingInventory::update(class Scene* const scene, const float delta) {
 
 			lastClickPos = slot;
 			lastClick = SDL_GetTicks();
-			scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL) = false;
-		} else if (scene->getSignal(EventManager::RIGHT_CLICK_DOWN_SIGNAL) && mPath.empty()) {
+			scene->events().consume(EventManager::LEFT_CLICK_EVENT);
+		} else if (scene->events().peek(EventManager::RIGHT_CLICK_EVENT) && mPath.empty()) {
 			// Not empty hand on empty slot
 			if (scene->mMouse.count == 0 && mCraftingCount[slot] == 0) {
 				return;
@@ -175,14 +175,14 @@ bool CraftingInventory::update(class Scene* const scene, const float delta) {
 				std::swap(scene->mMouse.item, mCraftingItems[slot]);
 			}
 
-			scene->getSignal(EventManager::RIGHT_CLICK_DOWN_SIGNAL) = false;
+			scene->events().consume(EventManager::RIGHT_CLICK_EVENT);
 		}
 
 		const auto select = [this, &scene, &slot](const SDL_Scancode s, const std::int64_t n) {
-			if (scene->getSignal(s)) {
+			if (scene->events().pressed(s)) {
 				std::swap(mCraftingCount[slot], mCount[n]);
 				std::swap(mCraftingItems[slot], mItems[n]);
-				scene->getSignal(s) = false;
+				scene->events().release(s);
 			}
 		};
 
@@ -207,9 +207,9 @@ bool CraftingInventory::update(class Scene* const scene, const float delta) {
 			return;
 		}
 
-		if (!scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL)) {
+		if (!scene->events().peek(EventManager::LEFT_CLICK_EVENT)) {
 			const auto select = [this, &scene](const SDL_Scancode s, const std::int64_t n) {
-				if (scene->getSignal(s) &&
+				if (scene->events().pressed(s) &&
 				    (mItems[n] == Components::AIR() ||
 				     mItems[n] == std::get<2>(registers::CRAFTING_RECIPIES.at(mLastCraft)).second)) {
 					mCount[n] += std::get<2>(registers::CRAFTING_RECIPIES.at(mLastCraft)).first;
@@ -228,7 +228,7 @@ bool CraftingInventory::update(class Scene* const scene, const float delta) {
 						}
 					}
 
-					scene->getSignal(s) = false;
+					scene->events().release(s);
 				}
 			};
 
@@ -268,16 +268,16 @@ bool CraftingInventory::update(class Scene* const scene, const float delta) {
 			}
 		}
 
-		scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL) = false;
+		scene->events().consume(EventManager::LEFT_CLICK_EVENT);
 	};
 
 	placeGrid();
 
 	const int slot = static_cast<int>((mouseX - ox) / slotx) + static_cast<int>((mouseY - oy) / sloty) * mCols;
 	if (!(mouseX < ox || mouseY < oy || mouseX > (ox + sizex) || mouseY > (oy + sizey))) {
-		if (scene->getSignal(EventManager::LEFT_HOLD_SIGNAL) ||
-		    scene->getSignal(EventManager::RIGHT_HOLD_SIGNAL)) {
-			mLeftLongClick = scene->getSignal(EventManager::LEFT_HOLD_SIGNAL);
+		if (scene->events().signal(EventManager::LEFT_HOLD_SIGNAL) ||
+		    scene->events().signal(EventManager::RIGHT_HOLD_SIGNAL)) {
+			mLeftLongClick = scene->events().signal(EventManager::LEFT_HOLD_SIGNAL);
 
 			// This is long click
 			// Now note the slots
@@ -471,11 +471,11 @@ void CraftingInventory::draw(class Scene* scene) {
 	shader->set("texture_diffuse"_u, 0);
 	shader->set("size"_u, sx / INVENTORY_INV_SCALE, sy / INVENTORY_INV_SCALE);
 
-	const bool virtItems =
-		scene->getSignal(EventManager::RIGHT_HOLD_SIGNAL) || scene->getSignal(EventManager::LEFT_HOLD_SIGNAL);
+	const bool virtItems = scene->events().signal(EventManager::RIGHT_HOLD_SIGNAL) ||
+			       scene->events().signal(EventManager::LEFT_HOLD_SIGNAL);
 
 	std::uint64_t vcount = 0;
-	if (scene->getSignal(EventManager::LEFT_HOLD_SIGNAL)) {
+	if (scene->events().signal(EventManager::LEFT_HOLD_SIGNAL)) {
 		if (!mPath.empty()) {
 			vcount = scene->mMouse.count / mPath.size();
 		}
@@ -64,10 +64,10 @@ bool FurnaceInventory::update(class Scene* const scene, const float delta) {
 			return;
 		}
 
-		if ((scene->getSignal(EventManager::LEFT_HOLD_SIGNAL) ||
-		     scene->getSignal(EventManager::RIGHT_HOLD_SIGNAL)) &&
+		if ((scene->events().signal(EventManager::LEFT_HOLD_SIGNAL) ||
+		     scene->events().signal(EventManager::RIGHT_HOLD_SIGNAL)) &&
 		    slot != 2) {
-			mLeftLongClick = scene->getSignal(EventManager::LEFT_HOLD_SIGNAL);
+			mLeftLongClick = scene->events().signal(EventManager::LEFT_HOLD_SIGNAL);
 
 			// This is long click
 			// Now note the slots
@@ -83,9 +83,9 @@ bool FurnaceInventory::update(class Scene* const scene, const float delta) {
 
 		static std::uint64_t lastClick;
 		static std::int64_t lastClickPos;
-		if (scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL)) {
+		if (scene->events().peek(EventManager::LEFT_CLICK_EVENT)) {
 			if ((mSmeltingCount[slot] == 0 && scene->mMouse.count != 0 && lastClickPos == slot &&
-			     (scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL) - lastClick) < 300ul)) {
+			     (scene->events().peek(EventManager::LEFT_CLICK_EVENT) - lastClick) < 300ul)) {
 				SDL_assert(scene->mMouse.item != Components::AIR());
 
 				// Here we get all stuff together
@@ -102,7 +102,7 @@ bool FurnaceInventory::update(class Scene* const scene, const float delta) {
 					}
 				}
 
-				scene->getSignal(DOUBLE_CLICK_SIGNAL) = false;
+				scene->events().consume(DOUBLE_CLICK_EVENT);
 				return;
 			}
 			// Normalize the buttons to grid cords
@@ -122,8 +122,8 @@ bool FurnaceInventory::update(class Scene* const scene, const float delta) {
 
 			lastClickPos = slot;
 			lastClick = SDL_GetTicks();
-			scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL) = false;
-		} else if (scene->getSignal(EventManager::RIGHT_CLICK_DOWN_SIGNAL) && mPath.empty()) {
+			scene->events().consume(EventManager::LEFT_CLICK_EVENT);
+		} else if (scene->events().peek(EventManager::RIGHT_CLICK_EVENT) && mPath.empty()) {
 			// Not empty hand on empty slot
 			if (scene->mMouse.count == 0 && mSmeltingCount[slot] == 0) {
 				return;
@@ -170,14 +170,14 @@ bool FurnaceInventory::update(class Scene* const scene, const float delta) {
 				}
 			}
 
-			scene->getSignal(EventManager::RIGHT_CLICK_DOWN_SIGNAL) = false;
+			scene->events().consume(EventManager::RIGHT_CLICK_EVENT);
 		}
 
 		const auto select = [this, &scene, &slot](const SDL_Scancode s, const std::int64_t n) {
-			if (scene->getSignal(s) && (slot != 2 || mItems[n] == Components::AIR())) {
+			if (scene->events().pressed(s) && (slot != 2 || mItems[n] == Components::AIR())) {
 				std::swap(mSmeltingCount[slot], mCount[n]);
 				std::swap(mSmeltingItems[slot], mItems[n]);
-				scene->getSignal(s) = false;
+				scene->events().release(s);
 			}
 		};
 
@@ -310,11 +310,11 @@ void FurnaceInventory::draw(class Scene* scene) {
 	shader->set("texture_diffuse"_u, 0);
 	shader->set("size"_u, sx / INVENTORY_INV_SCALE, sy / INVENTORY_INV_SCALE);
 
-	const bool virtItems =
-		scene->getSignal(EventManager::RIGHT_HOLD_SIGNAL) || scene->getSignal(EventManager::LEFT_HOLD_SIGNAL);
+	const bool virtItems = scene->events().signal(EventManager::RIGHT_HOLD_SIGNAL) ||
+			       scene->events().signal(EventManager::LEFT_HOLD_SIGNAL);
 
 	std::uint64_t vcount = 0;
-	if (scene->getSignal(EventManager::LEFT_HOLD_SIGNAL)) {
+	if (scene->events().signal(EventManager::LEFT_HOLD_SIGNAL)) {
 		if (!mPath.empty()) {
 			vcount = scene->mMouse.count / mPath.size();
 		}
@@ -119,14 +119,15 @@ bool Inventory::update(class Scene* scene, float) {
 	static std::int64_t mLastClickPos;
 	const std::int64_t slot = static_cast<std::int64_t>(mouseX / (INVENTORY_SLOT_X * scale)) +
 				  static_cast<std::int64_t>(mouseY / (INVENTORY_SLOT_Y * scale)) * 9;
-	if (scene->getSignal(EventManager::RIGHT_HOLD_SIGNAL) || scene->getSignal(EventManager::LEFT_HOLD_SIGNAL)) {
+	if (scene->events().signal(EventManager::RIGHT_HOLD_SIGNAL) ||
+	    scene->events().signal(EventManager::LEFT_HOLD_SIGNAL)) {
 		// Here we register all the slots touched by our long click
 		if (mouseX < 0 || mouseY < 0 || mouseX > (9 * INVENTORY_SLOT_X * scale) ||
 		    mouseY > (4 * INVENTORY_SLOT_Y * scale)) {
 			goto endLogic;
 		}
 
-		mLeftLongClick = scene->getSignal(EventManager::LEFT_HOLD_SIGNAL);
+		mLeftLongClick = scene->events().signal(EventManager::LEFT_HOLD_SIGNAL);
 
 		// This is long click
 		// Now note the slots
@@ -137,8 +138,8 @@ bool Inventory::update(class Scene* scene, float) {
 				mPath.emplace_back(pair);
 			}
 		}
-	} else if ((!scene->getSignal(EventManager::LEFT_HOLD_SIGNAL) &&
-		    !scene->getSignal(EventManager::RIGHT_HOLD_SIGNAL)) &&
+	} else if ((!scene->events().signal(EventManager::LEFT_HOLD_SIGNAL) &&
+		    !scene->events().signal(EventManager::RIGHT_HOLD_SIGNAL)) &&
 		   !mPath.empty()) {
 		// Here we redistribute the items
 		if (mLeftLongClick) {
@@ -174,15 +175,15 @@ bool Inventory::update(class Scene* scene, float) {
 		}
 
 		mPath.clear();
-	} else if (scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL) && mPath.empty()) {
+	} else if (scene->events().peek(EventManager::LEFT_CLICK_EVENT) && mPath.empty()) {
 		if (mouseX < 0 || mouseY < 0 || mouseX > (9 * INVENTORY_SLOT_X * scale) ||
 		    mouseY > (4 * INVENTORY_SLOT_Y * scale)) {
 			goto endLogic;
 		}
 
 		if ((mCount[slot] == 0 && scene->mMouse.count != 0 && mLastClickPos == slot &&
-		     (scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL) - mLastClick) < 300ul) ||
-		    scene->getSignal(DOUBLE_CLICK_SIGNAL)) {
+		     (scene->events().peek(EventManager::LEFT_CLICK_EVENT) - mLastClick) < 300ul) ||
+		    scene->events().peek(DOUBLE_CLICK_EVENT)) {
 			SDL_assert(scene->mMouse.item != Components::AIR());
 
 			// Here we get all stuff together
@@ -199,7 +200,7 @@ bool Inventory::update(class Scene* scene, float) {
 				}
 			}
 
-			scene->getSignal(DOUBLE_CLICK_SIGNAL) = false;
+			scene->events().consume(DOUBLE_CLICK_EVENT);
 			goto endLogic;
 		}
 
@@ -217,8 +218,8 @@ bool Inventory::update(class Scene* scene, float) {
 
 		mLastClickPos = slot;
 		mLastClick = SDL_GetTicks();
-		scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL) = false;
-	} else if (scene->getSignal(EventManager::RIGHT_CLICK_DOWN_SIGNAL) && mPath.empty()) {
+		scene->events().consume(EventManager::LEFT_CLICK_EVENT);
+	} else if (scene->events().peek(EventManager::RIGHT_CLICK_EVENT) && mPath.empty()) {
 		if (mouseX < 0 || mouseY < 0 || mouseX > (9 * INVENTORY_SLOT_X * scale) ||
 		    mouseY > (4 * INVENTORY_SLOT_Y * scale)) {
 			goto endLogic;
@@ -257,17 +258,17 @@ bool Inventory::update(class Scene* scene, float) {
 			std::swap(scene->mMouse.item, mItems[slot]);
 		}
 
-		scene->getSignal(EventManager::RIGHT_CLICK_DOWN_SIGNAL) = false;
+		scene->events().consume(EventManager::RIGHT_CLICK_EVENT);
 	}
 endLogic:
 
 	if (!(mouseX < 0 || mouseY < 0 || mouseX > (9 * INVENTORY_SLOT_X * scale) ||
 	      mouseY > (4 * INVENTORY_SLOT_Y * scale))) {
 		const auto select = [&scene, &slot](const SDL_Scancode s, const std::int64_t n) {
-			if (scene->getSignal(s) && n != slot) {
+			if (scene->events().pressed(s) && n != slot) {
 				std::swap(mCount[slot], mCount[n]);
 				std::swap(mItems[slot], mItems[n]);
-				scene->getSignal(s) = false;
+				scene->events().release(s);
 			}
 		};
 
@@ -287,7 +288,7 @@ endLogic:
 
 void Inventory::handleKeys(class Scene* const scene) {
 	// Quit menu
-	if (scene->getSignal(SDL_SCANCODE_ESCAPE)) {
+	if (scene->events().pressed(SDL_SCANCODE_ESCAPE)) {
 		mGame->getSystemManager()->getUISystem()->pop();
 	}
 }
@@ -366,11 +367,11 @@ void Inventory::drawItems(class Scene* const scene) {
 	shader->set("texture_diffuse"_u, 0);
 	shader->set("size"_u, x / INVENTORY_INV_SCALE, y / INVENTORY_INV_SCALE);
 
-	const bool virtItems =
-		scene->getSignal(EventManager::RIGHT_HOLD_SIGNAL) || scene->getSignal(EventManager::LEFT_HOLD_SIGNAL);
+	const bool virtItems = scene->events().signal(EventManager::RIGHT_HOLD_SIGNAL) ||
+			       scene->events().signal(EventManager::LEFT_HOLD_SIGNAL);
 
 	std::uint64_t vcount = 0;
-	if (scene->getSignal(EventManager::LEFT_HOLD_SIGNAL)) {
+	if (scene->events().signal(EventManager::LEFT_HOLD_SIGNAL)) {
 		if (!mPath.empty()) {
 			vcount = scene->mMouse.count / mPath.size();
 		}
@@ -424,11 +425,11 @@ void Inventory::drawMouse(Scene* scene) {
 		return;
 	}
 
-	const bool virtItems =
-		scene->getSignal(EventManager::RIGHT_HOLD_SIGNAL) || scene->getSignal(EventManager::LEFT_HOLD_SIGNAL);
+	const bool virtItems = scene->events().signal(EventManager::RIGHT_HOLD_SIGNAL) ||
+			       scene->events().signal(EventManager::LEFT_HOLD_SIGNAL);
 	std::uint64_t vcount = 0;
 	if (virtItems) {
-		if (scene->getSignal(EventManager::LEFT_HOLD_SIGNAL)) {
+		if (scene->events().signal(EventManager::LEFT_HOLD_SIGNAL)) {
 			if (!mPath.empty()) {
 				vcount = scene->mMouse.count - scene->mMouse.count % mPath.size();
 			}
@@ -1,34 +1,214 @@
 #include "components/noise.hpp"
 
-#include "utils.hpp"
-
 #include <SDL3/SDL.h>
-#include <random>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+// Whole registers of samples through the GCC and Clang vector extensions, which become SSE, AVX or NEON depending on
+// the target. MSVC, or a build with NOISE_SCALAR, only has the scalar loop, which gives the same values
+// Only as long as the compiler doesn't contract or reorder the math, so this file is built without fast math and
+// FMA contraction, see CMakeLists.txt. Otherwise the terrain would change with the flags and the machine
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(NOISE_SCALAR)
+#define NOISE_VECTOR
+
+#ifdef __AVX2__
+constexpr const static std::size_t LANES = 8;
+#else
+constexpr const static std::size_t LANES = 4;
+#endif
+
+using floats = float __attribute__((vector_size(LANES * sizeof(float))));
+using ints = std::int32_t __attribute__((vector_size(LANES * sizeof(float))));
+using uints = std::uint32_t __attribute__((vector_size(LANES * sizeof(float))));
+
+// 0, 1, 2... across the lanes
+static uints lanes() {
+	uints lanes{};
+	for (std::uint32_t i = 0; i < LANES; ++i) {
+		lanes[i] = i;
+	}
+
+	return lanes;
+}
+
+static floats toFloat(const uints value) { return __builtin_convertvector(std::bit_cast<ints>(value), floats); }
+#endif
+
+// Multiplied into the lattice coordinates before they are scrambled
+constexpr const static std::uint32_t X_PRIME = 0x27D4EB2DU;
+constexpr const static std::uint32_t Y_PRIME = 0x165667B1U;
+
+// Everything below is written once for a float and once for a register of them
+static float toFloat(const std::uint32_t value) { return static_cast<float>(static_cast<std::int32_t>(value)); }
+
+// Flips the sign of `value` where the top bit of `sign` is set
+template <typename F, typename U> static F flip(const F value, const U sign) {
+	return std::bit_cast<F>(std::bit_cast<U>(value) ^ (sign & 0x80000000U));
+}
+
+// A 32 bit integer hash, for the gradient at a point of the lattice
+template <typename U> static U scramble(U hash) {
+	hash = (hash ^ (hash >> 16)) * 0x7FEB352DU;
+	hash = (hash ^ (hash >> 15)) * 0x846CA68BU;
+
+	return hash ^ (hash >> 16);
+}
+
+template <typename F> static F fade(const F t) { return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f); }
+
+template <typename F> static F interpolate(const F a, const F b, const F t) { return a + (b - a) * t; }
+
+// 1D, the gradient is a slope between -1 and 1
+template <typename F, typename U> static F perlin(const std::uint32_t seed, const U cell, const F t) {
+	const auto gradient = [](const U hash, const F distance) {
+		return (toFloat(hash >> 8) * 0x1.0p-23f - 1.0f) * distance;
+	};
+	const U left = scramble(seed ^ cell * X_PRIME);
+	const U right = scramble(seed ^ (cell + 1) * X_PRIME);
+
+	return 2.0f * interpolate(gradient(left, t), gradient(right, t - 1.0f), fade(t));
+}
+
+// 2D, for a column of points between two rows of the lattice, the gradients are the four diagonals
+template <typename F, typename U>
+static F perlin(const std::uint32_t left, const std::uint32_t right, const float tx, const U cell, const F ty) {
+	const auto gradient = [](const U hash, const F x, const F y) {
+		return flip(x, hash << 31) + flip(y, hash << 30);
+	};
+	const F x = F{} + tx;
+	const F y = ty;
+	const F fx = F{} + fade(tx);
+
+	const F bottom = interpolate(gradient(scramble(left ^ cell * Y_PRIME), x, y),
+			      gradient(scramble(right ^ cell * Y_PRIME), x - 1.0f, y), fx);
+	const F top = interpolate(gradient(scramble(left ^ (cell + 1) * Y_PRIME), x, y - 1.0f),
+			   gradient(scramble(right ^ (cell + 1) * Y_PRIME), x - 1.0f, y - 1.0f), fx);
+
+	return interpolate(bottom, top, fade(y));
+}
+
+// Where the blocks from `position` on are in a lattice of `period` wide cells
+// The cells are counted in 64 bits and only the bits the hash sees are kept, so the noise is as fine far from spawn
+struct lattice {
+	lattice(const std::int64_t position, const std::uint32_t period)
+		: cell(static_cast<std::uint32_t>(position >> std::countr_zero(period))),
+		  offset(static_cast<std::uint32_t>(position & (period - 1))), shift(std::countr_zero(period)),
+		  mask(period - 1), scale(1.0f / static_cast<float>(period)) {}
+
+	// The cell of the first block, and how far in it that block is
+	const std::uint32_t cell;
+	const std::uint32_t offset;
+
+	const int shift;
+	const std::uint32_t mask;
+	const float scale;
+};
+
+// Adds `amplitude * sample(offset of the block in the first cell)` to every value, a register at a time
+template <typename Sample>
+static void accumulate(const std::span<float> values, const std::uint32_t offset, const float amplitude,
+		       const Sample& sample) {
+	std::size_t i = 0;
+
+#ifdef NOISE_VECTOR
+	for (; i + LANES <= values.size(); i += LANES) {
+		floats sum;
+		std::memcpy(&sum, values.data() + i, sizeof(sum));
+		sum += amplitude * sample(offset + static_cast<std::uint32_t>(i) + lanes());
+		std::memcpy(values.data() + i, &sum, sizeof(sum));
+	}
+#endif
+
+	for (; i < values.size(); ++i) {
+		values[i] += amplitude * sample(offset + static_cast<std::uint32_t>(i));
+	}
+}
 
 NoiseGenerator::NoiseGenerator()
 	: NoiseGenerator((static_cast<decltype(mSeed)>(SDL_rand_bits()) << sizeof(Sint32) ^
 			  static_cast<decltype(mSeed)>(SDL_rand_bits())) &
 			 0x7FFFFFFFFFFFFFFF) {}
 
-NoiseGenerator::NoiseGenerator(const std::uint64_t seed) : mSeed(seed), mRng(seed) {}
+NoiseGenerator::NoiseGenerator(const std::uint64_t seed) : mSeed(seed) {}
+
+void NoiseGenerator::getNoise(const Feature feature, const std::int64_t x, const std::span<float> noise,
+			      const octaves shape) const {
+	std::ranges::fill(noise, 0.0f);
+
+	float amplitude = 1.0f;
+	float total = 0.0f;
+	for (std::uint32_t octave = 0; octave < shape.count; ++octave) {
+		const lattice row(x, std::max(shape.period >> octave, 1U));
+		const std::uint32_t seed = seedOf(feature, octave);
+
+		const auto sample = [&](const auto local) {
+			return perlin(seed, row.cell + (local >> row.shift), toFloat(local & row.mask) * row.scale);
+		};
+		accumulate(noise, row.offset, amplitude, sample);
+
+		total += amplitude;
+		amplitude *= 0.5f;
+	}
+
+	for (float& value : noise) {
+		value /= total;
+	}
+}
+
+void NoiseGenerator::getNoise(const Feature feature, const std::int64_t x, const std::int64_t y,
+			      const std::span<float> noise, const octaves shape) const {
+	std::ranges::fill(noise, 0.0f);
+
+	float amplitude = 1.0f;
+	float total = 0.0f;
+	for (std::uint32_t octave = 0; octave < shape.count; ++octave) {
+		const std::uint32_t period = std::max(shape.period >> octave, 1U);
+		const lattice row(x, period);
+		const lattice column(y, period);
+		const std::uint32_t seed = seedOf(feature, octave);
+
+		// The whole column is in the same two rows of the lattice
+		const std::uint32_t left = seed ^ row.cell * X_PRIME;
+		const std::uint32_t right = seed ^ (row.cell + 1) * X_PRIME;
+		const float tx = static_cast<float>(row.offset) * row.scale;
+
+		const auto sample = [&](const auto local) {
+			return perlin(left, right, tx, column.cell + (local >> column.shift),
+				      toFloat(local & column.mask) * column.scale);
+		};
+		accumulate(noise, column.offset, amplitude, sample);
+
+		total += amplitude;
+		amplitude *= 0.5f;
+	}
+
+	for (float& value : noise) {
+		value /= total;
+	}
+}
+
+float NoiseGenerator::randf(const std::int64_t x, const std::int64_t y, const Feature feature,
+			    const std::uint32_t index) const {
+	// The top 24 bits fill the mantissa exactly
+	return static_cast<float>(hash(x, y, feature, index) >> 40) * 0x1.0p-24f;
+}
 
-double NoiseGenerator::getNoise(std::int64_t x) const {
-	// Remove the sign -> unsigned x
-	const auto ux = x * ((x < 0) ? -1 : 1);
-	// Add the seed -> random x
-	const auto rx = ux ^ mSeed;
-	// Cast to double -> double x
-	const double dx = static_cast<double>(rx); // Oh well...
+std::uint64_t NoiseGenerator::hash(const std::int64_t x, const std::int64_t y, const Feature feature,
+				   const std::uint32_t index) const {
+	// Each key goes through the mixer in turn, golden ratio apart so zeros don't cancel out
+	constexpr const static std::uint64_t golden = 0x9E3779B97F4A7C15ULL;
 
-	const double noise = 0.4 * (1.0 * SDL_sin(0.2 * dx)		 // Random 1
-				    + 0.9 * SDL_sin(0.1 * PI * dx)	 // Ransom 3
-				    - 0.0 * SDL_sin(-0.9 * EULER * dx)); // Random 2
-									 // We are only using 2 degrees of randomness
+	std::uint64_t hash = mix(mSeed + golden);
+	hash = mix(hash ^ (static_cast<std::uint64_t>(x) + golden));
+	hash = mix(hash ^ (static_cast<std::uint64_t>(y) + 2 * golden));
 
-	return noise;
+	return mix(hash ^ ((static_cast<std::uint64_t>(feature) << 32 | index) + 3 * golden));
 }
 
-float NoiseGenerator::randf() {
-	static std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
-	return distribution(mRng);
+std::uint32_t NoiseGenerator::seedOf(const Feature feature, const std::uint32_t octave) const {
+	return static_cast<std::uint32_t>(hash(0, 0, feature, octave));
 }
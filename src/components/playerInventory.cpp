@@ -2,10 +2,9 @@
 
 #include "components.hpp"
 #include "game.hpp"
-#include "managers/systemManager.hpp"
-#include "opengl/texture.hpp"
 #include "registers.hpp"
 #include "scene.hpp"
+#include "scenes/level.hpp"
 #include "third_party/Eigen/Core"
 #include "third_party/rapidjson/fwd.h"
 
@@ -22,7 +21,7 @@ bool PlayerInventory::update(class Scene* scene, float delta) { return CraftingI
 
 void PlayerInventory::draw(class Scene* scene) { CraftingInventory::draw(scene); }
 
-void PlayerInventory::tryPlace(class Scene* scene, const Eigen::Vector2i& pos) {
+void PlayerInventory::tryPlace(class Scene*, const Eigen::Vector2i& pos) {
 	if (mItems[mSelect] == Components::AIR() || mCount[mSelect] == 0) {
 		return;
 	}
@@ -32,19 +31,9 @@ void PlayerInventory::tryPlace(class Scene* scene, const Eigen::Vector2i& pos) {
 		return;
 	}
 
-	Texture* texture = mGame->getSystemManager()->getTexture(registers::TEXTURES.at(mItems[mSelect]));
-	const EntityID entity = scene->newEntity();
-	scene->emplace<Components::block>(entity, mItems[mSelect], pos);
-	scene->emplace<Components::texture>(entity, texture);
-
-	if (registers::COLLISION_BOXES.contains(mItems[mSelect])) {
-		const auto& box = registers::COLLISION_BOXES.at(mItems[mSelect]);
-
-		if (!(box.second.x() == 0 || box.second.y() == 0)) {
-			scene->emplace<Components::collision>(entity, box.first, box.second, true);
-		}
-	} else {
-		scene->emplace<Components::collision>(entity, Eigen::Vector2f(0.0f, 0.0f), texture->getSize(), true);
+	// The chunk might not be loaded
+	if (!mGame->getLevel()->setBlock(pos, mItems[mSelect])) {
+		return;
 	}
 
 	--mCount[mSelect];
@@ -1,25 +1,109 @@
 #include "managers/entityManager.hpp"
 
+#include "misc/snapshot.hpp"
+
 #include <SDL3/SDL.h>
-#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstring>
+#include <utility>
 
-EntityManager::EntityManager() : mNext(1) {}
+EntityManager::EntityManager() : mGenerations(1, 0) {}
 
 EntityID EntityManager::getEntity() {
 	if (!mReleased.empty()) {
-		EntityID first = mReleased.front();
+		const std::uint32_t index = mReleased.front();
 		mReleased.pop_front();
-		return first;
+
+		return makeEntity(index, mGenerations[index]);
 	}
 
-	return mNext++;
+	SDL_assert(mGenerations.size() <= MAX_ENTITIES && "Ran out of entity indices");
+
+	mGenerations.emplace_back(0);
+
+	return makeEntity(mGenerations.size() - 1, 0);
+}
+
+void EntityManager::getEntities(std::size_t count, std::vector<EntityID>& entities) {
+	entities.reserve(entities.size() + count);
+
+	for (; count != 0 && !mReleased.empty(); --count) {
+		entities.emplace_back(getEntity());
+	}
+
+	SDL_assert(mGenerations.size() + count <= MAX_ENTITIES + 1 && "Ran out of entity indices");
+
+	// The rest are fresh indices, so grow the table once
+	const std::size_t first = mGenerations.size();
+	mGenerations.resize(first + count, 0);
+	for (std::size_t index = first; index < mGenerations.size(); ++index) {
+		entities.emplace_back(makeEntity(index, 0));
+	}
 }
 
 void EntityManager::releaseEntity(const EntityID entity) {
-	mReleased.emplace_back(entity);
+	if (!valid(entity)) {
+		SDL_Log("\033[93mEntityManager: Releasing invalid entity %" PRIu64 "!\033[0m", entity);
+
+		return;
+	}
+
+	// Every handle to the old generation is now stale
+	++mGenerations[entityIndex(entity)];
+	mReleased.emplace_back(entityIndex(entity));
 }
 
 bool EntityManager::valid(const EntityID entity) const {
-	return entity != 0 && std::find(mReleased.begin(), mReleased.end(), entity) == mReleased.end() &&
-	       entity < mNext;
+	const std::uint32_t index = entityIndex(entity);
+
+	return index != 0 && index < mGenerations.size() && mGenerations[index] == entityGeneration(entity);
+}
+
+void EntityManager::save(utils::snapshot_writer& writer) const {
+	writer.write(static_cast<std::uint64_t>(mGenerations.size()));
+	writer.bytes(mGenerations.data(), mGenerations.size() * sizeof(std::uint32_t));
+
+	writer.write(static_cast<std::uint64_t>(mReleased.size()));
+	for (const auto index : mReleased) {
+		writer.write(index);
+	}
+}
+
+bool EntityManager::restore(utils::snapshot_reader& reader) {
+	mGenerations.assign(1, 0);
+	mReleased.clear();
+
+	std::uint64_t count = 0;
+	if (!reader.read(count) || count == 0 || count > MAX_ENTITIES + 1) {
+		return false;
+	}
+
+	const std::byte* const generations = reader.bytes(count * sizeof(std::uint32_t));
+	if (generations == nullptr) {
+		return false;
+	}
+
+	std::vector<std::uint32_t> restored(count);
+	std::memcpy(restored.data(), generations, count * sizeof(std::uint32_t));
+
+	std::uint64_t released = 0;
+	if (!reader.read(released) || released >= count) {
+		return false;
+	}
+
+	std::deque<std::uint32_t> indices;
+	for (std::uint64_t i = 0; i < released; ++i) {
+		std::uint32_t index = 0;
+		if (!reader.read(index) || index == 0 || index >= count) {
+			return false;
+		}
+
+		indices.emplace_back(index);
+	}
+
+	mGenerations = std::move(restored);
+	mReleased = std::move(indices);
+
+	return true;
 }
@@ -25,12 +25,12 @@ SDL_AppResult EventManager::manageEvent(const SDL_Event& event) {
 				return SDL_APP_FAILURE;
 			}
 			// Mark the scancode as pressed
-			mGame->getLevel()->getScene()->getSignal(event.key.scancode) = true;
+			mGame->getLevel()->getScene()->events().press(event.key.scancode);
 			break;
 		}
 
 		case SDL_EVENT_KEY_UP: {
-			mGame->getLevel()->getScene()->getSignal(event.key.scancode) = false;
+			mGame->getLevel()->getScene()->events().release(event.key.scancode);
 			break;
 		}
 
@@ -58,17 +58,17 @@ SDL_AppResult EventManager::manageEvent(const SDL_Event& event) {
 			if (event.button.button == SDL_BUTTON_LEFT) {
 				// If the time since press is less than threshold, treat as a click
 				if (now - mLeftClickDown < ACTIVATION_TIME) {
-					// Mark the left-click-down signal
-					mGame->getLevel()->getScene()->getSignal(LEFT_CLICK_DOWN_SIGNAL) = now;
-					mGame->getLevel()->getScene()->getSignal(LEFT_HOLD_SIGNAL) = false;
+					// Queue the click for this frame
+					mGame->getLevel()->getScene()->events().push(LEFT_CLICK_EVENT, now);
+					mGame->getLevel()->getScene()->events().signal(LEFT_HOLD_SIGNAL) = false;
 				}
 
 				// Reset the timestamp
 				mLeftClickDown = 0;
 			} else if (event.button.button == SDL_BUTTON_RIGHT) {
 				if (now - mRightClickDown < ACTIVATION_TIME) {
-					mGame->getLevel()->getScene()->getSignal(RIGHT_CLICK_DOWN_SIGNAL) = now;
-					mGame->getLevel()->getScene()->getSignal(RIGHT_HOLD_SIGNAL) = false;
+					mGame->getLevel()->getScene()->events().push(RIGHT_CLICK_EVENT, now);
+					mGame->getLevel()->getScene()->events().signal(RIGHT_HOLD_SIGNAL) = false;
 				}
 
 				mRightClickDown = 0;
@@ -95,11 +95,11 @@ void EventManager::update() {
 
 		// If the button is held beyond the threshold, mark as hold
 		if (isLeftDown && !isShortPressTime) {
-			mGame->getLevel()->getScene()->getSignal(LEFT_HOLD_SIGNAL) = mLeftClickDown;
-			mGame->getLevel()->getScene()->getSignal(LEFT_CLICK_DOWN_SIGNAL) = false;
+			mGame->getLevel()->getScene()->events().signal(LEFT_HOLD_SIGNAL) = mLeftClickDown;
+			mGame->getLevel()->getScene()->events().consume(LEFT_CLICK_EVENT);
 		} else {
 			// Not holding
-			mGame->getLevel()->getScene()->getSignal(LEFT_HOLD_SIGNAL) = false;
+			mGame->getLevel()->getScene()->events().signal(LEFT_HOLD_SIGNAL) = false;
 		}
 	}
 
@@ -109,10 +109,10 @@ void EventManager::update() {
 		const bool isShortPressTime = (now - mRightClickDown <= ACTIVATION_TIME);
 
 		if (isRightDown && !isShortPressTime) {
-			mGame->getLevel()->getScene()->getSignal(RIGHT_HOLD_SIGNAL) = mRightClickDown;
-			mGame->getLevel()->getScene()->getSignal(RIGHT_CLICK_DOWN_SIGNAL) = false;
+			mGame->getLevel()->getScene()->events().signal(RIGHT_HOLD_SIGNAL) = mRightClickDown;
+			mGame->getLevel()->getScene()->events().consume(RIGHT_CLICK_EVENT);
 		} else {
-			mGame->getLevel()->getScene()->getSignal(RIGHT_HOLD_SIGNAL) = false;
+			mGame->getLevel()->getScene()->events().signal(RIGHT_HOLD_SIGNAL) = false;
 		}
 	}
 }
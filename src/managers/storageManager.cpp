@@ -202,9 +202,6 @@ void StorageManager::saveState(SDL_Storage* storage) {
 		worlds.SetObject();
 	}
 
-	// FIXME: Non-hard writted world name, ask for user input
-	constexpr const static char* worldName = "world";
-
 	// TODO: Save some more world info
 	// TODO: Self-recovery incase of corrupted world save
 	worlds.AddMember("version", rapidjson::Value().SetUint64(LATEST_WORLD_VERSION).Move(), worlds.GetAllocator());
@@ -213,8 +210,8 @@ void StorageManager::saveState(SDL_Storage* storage) {
 		worlds.AddMember("worlds", rapidjson::Value(rapidjson::kArrayType).Move(), worlds.GetAllocator());
 	}
 
-	if (std::find(worlds["worlds"].Begin(), worlds["worlds"].End(), worldName) == worlds["worlds"].End()) {
-		worlds["worlds"].PushBack(rapidjson::Value(worldName, worlds.GetAllocator()).Move(),
+	if (std::find(worlds["worlds"].Begin(), worlds["worlds"].End(), WORLD_NAME) == worlds["worlds"].End()) {
+		worlds["worlds"].PushBack(rapidjson::Value(WORLD_NAME, worlds.GetAllocator()).Move(),
 					  worlds.GetAllocator());
 	}
 
@@ -229,7 +226,28 @@ void StorageManager::saveState(SDL_Storage* storage) {
 
 	SDL_WriteStorageFile(storage, "worlds.json", sb.GetString(), sb.GetSize());
 
-	saveWorld(storage, worldName);
+	saveWorld(storage, WORLD_NAME);
+}
+
+std::string StorageManager::getRegionPath() {
+	// The user storage is the pref path on desktop, so the regions end up next to the world file
+	char* const pref = SDL_GetPrefPath("cyao", "2d-minecraft");
+	if (pref == nullptr) {
+		SDL_LogCritical(SDL_LOG_CATEGORY_VIDEO, "\033[31mFailed to get the pref path: %s\033[0m",
+				SDL_GetError());
+
+		return "";
+	}
+
+	const std::string path = std::string(pref) + WORLD_NAME + "/";
+	SDL_free(pref);
+
+	if (!SDL_CreateDirectory(path.data())) {
+		SDL_LogCritical(SDL_LOG_CATEGORY_VIDEO, "\033[31mFailed to create %s: %s\033[0m", path.data(),
+				SDL_GetError());
+	}
+
+	return path;
 }
 
 void StorageManager::saveWorld(struct SDL_Storage* storage, const std::string& world) {
@@ -254,5 +272,13 @@ void StorageManager::saveWorld(struct SDL_Storage* storage, const std::string& w
 	rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
 	level.Accept(writer);
 
-	SDL_WriteStorageFile(storage, (world + ".json").data(), sb.GetString(), sb.GetSize());
+	if (!SDL_WriteStorageFile(storage, (world + ".json").data(), sb.GetString(), sb.GetSize())) {
+		SDL_LogCritical(SDL_LOG_CATEGORY_VIDEO, "\033[31mFailed to write %s.json: %s\033[0m", world.data(),
+				SDL_GetError());
+
+		return;
+	}
+
+	// Only now that the level is saved, a new one may have replaced an older world
+	mGame->getLevel()->dropOldRegions();
 }
@@ -137,6 +137,9 @@ void SystemManager::update(Scene* scene, const float delta) {
 	// This is after since it will delete stuff
 	mInputSystem->update(scene, delta);
 
+	// Apply the entities created and erased by the systems above in one go, before drawing
+	scene->flush();
+
 	mRenderSystem->draw(scene); // 36.51%
 	mInputSystem->draw(scene);
 	mTextSystem->draw(scene);
@@ -146,8 +149,8 @@ void SystemManager::update(Scene* scene, const float delta) {
 
 	mRenderSystem->present();
 
-	scene->getSignal(EventManager::LEFT_CLICK_DOWN_SIGNAL) = false;
-	scene->getSignal(EventManager::RIGHT_CLICK_DOWN_SIGNAL) = false;
+	// Clicks nobody took are dropped, they belonged to this frame
+	scene->events().endFrame();
 }
 
 void SystemManager::updatePlayer(Scene* scene) {
@@ -157,12 +160,12 @@ void SystemManager::updatePlayer(Scene* scene) {
 	}
 
 	const auto select = [&scene](SDL_Scancode s, std::size_t n) {
-		if (scene->getSignal(s)) {
+		if (scene->events().pressed(s)) {
 			static_cast<PlayerInventory*>(
 				scene->get<Components::inventory>(Game::getInstance()->getPlayerID()).mInventory)
 				->select(n);
 
-			scene->getSignal(s) = false;
+			scene->events().release(s);
 		}
 	};
 
@@ -190,8 +193,15 @@ void SystemManager::printDebug([[maybe_unused]] Scene* scene) {
 	if (signalList) {
 		ImGui::Begin("Signal list");
 
-		for (const auto& [name, value] : scene->mSignals) {
-			ImGui::BulletText("%s", std::format("{}: {}", name, value).data());
+		const auto& signals = scene->events().signals();
+		for (std::size_t i = 0; i < signals.size(); ++i) {
+			ImGui::BulletText("%s", std::format("{}: {}", i, signals[i]).data());
+		}
+
+		for (int key = 0; key < SDL_SCANCODE_COUNT; ++key) {
+			if (scene->events().pressed(static_cast<SDL_Scancode>(key))) {
+				ImGui::BulletText("%s", SDL_GetScancodeName(static_cast<SDL_Scancode>(key)));
+			}
 		}
 
 		ImGui::End();
@@ -2,44 +2,91 @@
 
 #include "components.hpp"
 #include "components/noise.hpp"
-#include "game.hpp"
 #include "items.hpp"
-#include "managers/entityManager.hpp"
-#include "managers/systemManager.hpp"
-#include "opengl/texture.hpp"
 #include "registers.hpp"
-#include "scene.hpp"
 #include "third_party/Eigen/Core"
-#include "third_party/rapidjson/allocators.h"
 #include "third_party/rapidjson/document.h"
 #include "third_party/rapidjson/rapidjson.h"
 
 #include <SDL3/SDL.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cinttypes>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+// The noise of the terrain, the caves and how rich in ores the stone is
+constexpr const static NoiseGenerator::octaves TERRAIN = {64, 3};
+constexpr const static NoiseGenerator::octaves CAVES = {32, 3};
+constexpr const static NoiseGenerator::octaves ORES = {16, 2};
+// Stone where the cave noise is this close to 0 is carved out, which gives long winding tunnels
+constexpr const static float CAVE_WIDTH = 0.025f;
+// Caves stay this far under the surface, and off the bottom of the world
+constexpr const static int CAVE_ROOF = 4;
+constexpr const static int CAVE_FLOOR = 2;
+
+static std::uint64_t heightOf(const float noise) {
+	return static_cast<std::uint64_t>(Chunk::WATER_LEVEL + Chunk::HILL_HEIGHT * noise);
+}
+
+// How far structures reach sideways from the column they grow on
+static int structureReach() {
+	const static int reach = [] {
+		int widest = 0;
+		for (const auto& [chance, structure] : registers::SURFACE_STRUCTURES) {
+			for (const auto& [type, offset] : structure) {
+				widest = std::max(widest, std::abs(offset.x()));
+			}
+		}
 
-Chunk::Chunk(Scene* scene, NoiseGenerator* const noise, const std::int64_t position) : mPosition(position) {
-	// We shall first generate a chunk map
-	// Then we shall spawn the blocks
+		return widest;
+	}();
 
-	// Indexed by x and then y
-	std::vector<std::vector<Components::Item>> grid(CHUNK_WIDTH, std::vector(WATER_LEVEL * 2, Components::AIR()));
+	return reach;
+}
 
-	// Spawn blocks
+std::uint64_t Chunk::surfaceOf(const NoiseGenerator* const noise, const std::int64_t x) {
+	float height = 0.0f;
+	noise->getNoise(NoiseGenerator::Feature::HEIGHT, x, std::span(&height, 1), TERRAIN);
+
+	return heightOf(height);
+}
+
+Chunk::Chunk(const NoiseGenerator* const noise, const std::int64_t position)
+	: mPosition(position), mDirty(true), mTiles() {
+	// We shall first generate the height map
+	// Then fill the grid, structures, caves and ores
+	// The heights go past the edges, for the structures growing in from the neighbours
 	const auto offset = mPosition * CHUNK_WIDTH;
-	for (std::uint64_t i = 0; i < CHUNK_WIDTH; ++i) {
-		const double height = noise->getNoise(i + position * CHUNK_WIDTH);
-		const std::uint64_t block_height = WATER_LEVEL + 5 * height;
+	const int reach = structureReach();
+	std::vector<float> heights(CHUNK_WIDTH + 2 * reach);
+	noise->getNoise(NoiseGenerator::Feature::HEIGHT, offset - reach, heights, TERRAIN);
+
+	for (int i = 0; i < CHUNK_WIDTH; ++i) {
+		const std::uint64_t block_height = heightOf(heights[i + reach]);
 		mHeightMap[i] = block_height;
 
 		for (std::uint64_t y = 0; y < block_height; ++y) {
-			grid[i][y] = Components::Item::STONE;
+			at(i, y) = static_cast<tile>(Components::Item::STONE);
 		}
-		grid[i][block_height] = Components::Item::GRASS_BLOCK;
+		at(i, block_height) = static_cast<tile>(Components::Item::GRASS_BLOCK);
+	}
 
-		// Spawn structures
-		for (const auto& [chance, structure] : registers::SURFACE_STRUCTURES) {
-			double roll = noise->randf();
+	// Spawn structures, left to right, including the neighbours' that grow over the edge. Every chunk places its
+	// own part, so the trees on the border come out whole whichever side is generated first
+	for (int i = -reach; i < CHUNK_WIDTH + reach; ++i) {
+		const std::uint64_t block_height = heightOf(heights[i + reach]);
+
+		for (std::uint32_t kind = 0; kind < registers::SURFACE_STRUCTURES.size(); ++kind) {
+			const auto& [chance, structure] = registers::SURFACE_STRUCTURES[kind];
+			double roll = noise->randf(i + offset, block_height, NoiseGenerator::Feature::STRUCTURE, kind);
 
 			// Rig the roll so there is always a tree near
 			if (i + offset == 3) {
@@ -47,205 +94,265 @@ Chunk::Chunk(Scene* scene, NoiseGenerator* const noise, const std::int64_t posit
 			}
 
 			if (roll < chance) {
-				spawnStructure(grid, Eigen::Vector2i(i, block_height), structure, scene);
+				spawnStructure(Eigen::Vector2i(i, block_height), structure);
 			}
 		}
 	}
 
-	carve(grid, noise);
-	spawnOres(grid, noise);
+	carve(noise);
+	spawnOres(noise);
+}
 
-	// Finally spawn the blocks
-	const auto& blockView = scene->view<Components::block>();
-	for (std::uint64_t x = 0; x < CHUNK_WIDTH; ++x) {
-		for (std::uint64_t y = 0; y < WATER_LEVEL * 2; ++y) {
-			if (grid[x][y] == Components::AIR()) {
-				continue;
-			}
+// Loading from save
+Chunk::Chunk(const rapidjson::Value& data) : mPosition(data[POSITION_KEY].GetInt64()), mDirty(true), mTiles() {
+	for (rapidjson::SizeType i = 0; i < data[BLOCKS_KEY].Size(); i++) {
+		const Components::Item block = static_cast<Components::Item>(data[BLOCKS_KEY][i][0].GetUint64());
+		const Eigen::Vector2i position = getVector2i(data[BLOCKS_KEY][i][1]);
 
-			const Eigen::Vector2i pos = Eigen::Vector2i(x + mPosition * CHUNK_WIDTH, y);
+		SDL_assert(registers::TEXTURES.contains(block));
 
-			Components::Item occupied = Components::AIR();
-			for (const auto block : blockView) {
-				if (scene->get<Components::block>(block).mPosition == pos) {
-					occupied = scene->get<Components::block>(block).mType;
-					break;
-				}
-			}
+		if (!contains(position)) {
+			SDL_Log("\033[33mBlock at %d %d isn't in chunk %" PRIi64 ", dropping it\033[0m", position.x(),
+				position.y(), mPosition);
 
-			if (occupied != Components::AIR()) {
-				grid[x][y] = occupied;
+			continue;
+		}
 
-				continue;
-			}
+		setBlock(position, block);
+	}
+}
 
-			Texture* const texture =
-				Game::getInstance()->getSystemManager()->getTexture(registers::TEXTURES.at(grid[x][y]));
-			const EntityID entity = scene->newEntity();
-			scene->emplace<Components::block>(entity, grid[x][y], Eigen::Vector2i(x + offset, y));
-			scene->emplace<Components::texture>(entity, texture);
-
-			if (registers::COLLISION_BOXES.contains(grid[x][y])) {
-				const auto& collision = registers::COLLISION_BOXES.at(grid[x][y]);
-				scene->emplace<Components::collision>(entity, collision.first, collision.second, true);
-			} else {
-				scene->emplace<Components::collision>(entity, Eigen::Vector2f(0.0f, 0.0f),
-								      texture->getSize(), true);
-			}
-		}
+// Run lengths are LEB128, a column of air fits in two bytes
+static void writeLength(std::vector<std::uint8_t>& out, std::uint32_t length) {
+	while (length >= 0x80) {
+		out.emplace_back(static_cast<std::uint8_t>(length | 0x80));
+		length >>= 7;
 	}
+
+	out.emplace_back(static_cast<std::uint8_t>(length));
 }
 
-// Loading from save
-Chunk::Chunk(const rapidjson::Value& data, Scene* scene) : mPosition(data[POSITION_KEY].GetInt64()) {
-	for (rapidjson::SizeType i = 0; i < data[BLOCKS_KEY].Size(); i++) {
-		const Components::Item block = static_cast<Components::Item>(data[BLOCKS_KEY][i][0].GetUint64());
+static bool readLength(utils::snapshot_reader& reader, std::uint32_t& length) {
+	length = 0;
 
-		SDL_assert(registers::TEXTURES.contains(block));
+	for (int shift = 0; shift < 32; shift += 7) {
+		std::uint8_t byte = 0;
+		if (!reader.read(byte)) {
+			return false;
+		}
+
+		length |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
 
-		Texture* const texture =
-			Game::getInstance()->getSystemManager()->getTexture(registers::TEXTURES.at(block));
+	return false;
+}
 
-		const EntityID entity = scene->newEntity();
-		scene->emplace<Components::block>(entity, block, getVector2i(data[BLOCKS_KEY][i][1]));
-		scene->emplace<Components::texture>(entity, texture);
+std::unique_ptr<Chunk> Chunk::load(const std::span<const std::byte> data) {
+	utils::snapshot_reader reader(data);
 
-		if (registers::COLLISION_BOXES.contains(block)) {
-			const auto& box = registers::COLLISION_BOXES.at(block);
+	std::uint8_t format = 0;
+	std::int64_t position = 0;
+	if (!reader.read(format) || !reader.read(position)) {
+		return nullptr;
+	}
 
-			if (!(box.second.x() == 0 || box.second.y() == 0)) {
-				scene->emplace<Components::collision>(entity, box.first, box.second, true);
-			}
-		} else {
-			scene->emplace<Components::collision>(entity, Eigen::Vector2f(0.0f, 0.0f), texture->getSize(),
-							      true);
+	std::unique_ptr<Chunk> chunk(new Chunk(position));
+
+	// The grid as is, from before the palette
+	if (format == RAW_FORMAT) {
+		const std::byte* const tiles = reader.bytes(sizeof(mTiles));
+		if (tiles == nullptr || !reader.done()) {
+			return nullptr;
 		}
+
+		std::memcpy(chunk->mTiles.data(), tiles, sizeof(mTiles));
+
+		return chunk;
 	}
-}
 
-void Chunk::save(class Scene* scene, rapidjson::Value& chunk, rapidjson::MemoryPoolAllocator<>& allocator) {
-	chunk.AddMember(rapidjson::StringRef(POSITION_KEY), rapidjson::Value(mPosition).Move(), allocator);
-	chunk.AddMember(rapidjson::StringRef(BLOCKS_KEY), rapidjson::Value(rapidjson::kArrayType).Move(), allocator);
+	std::uint16_t types = 0;
+	if (format != FORMAT || !reader.read(types) || types == 0) {
+		return nullptr;
+	}
 
-	/*
-	for (const auto item : scene->view<Components::item>()) {
-		// 0 runs??
-		SDL_Log("Item");
+	std::vector<tile> palette(types);
+	const std::byte* const paletteData = reader.bytes(types * sizeof(tile));
+	std::uint16_t runs = 0;
+	if (paletteData == nullptr || !reader.read(runs)) {
+		return nullptr;
+	}
+	std::memcpy(palette.data(), paletteData, types * sizeof(tile));
 
-		// Not in the chunk
-		if ((scene->get<Components::position>(item).mPosition.x() / Components::block::BLOCK_SIZE /
-			     CHUNK_WIDTH -
-		     (scene->get<Components::position>(item).mPosition.x() < 0)) != mPosition) {
-			continue;
+	std::vector<std::uint32_t> lengths(runs);
+	for (auto& length : lengths) {
+		if (!readLength(reader, length)) {
+			return nullptr;
 		}
+	}
 
-		chunk[ITEMS_KEY].PushBack({etoi(scene->template get<Components::item>(item).mType),
-					    scene->template get<Components::position>(item).mPosition});
+	const int bits = std::bit_width(types - 1u);
+	const std::byte* const indices = reader.bytes((runs * bits + 7) / 8);
+	if (indices == nullptr || !reader.done()) {
+		return nullptr;
+	}
+
+	std::size_t cell = 0;
+	std::size_t bit = 0;
+	for (std::size_t run = 0; run < runs; ++run) {
+		std::uint32_t index = 0;
+		for (int i = 0; i < bits; ++i, ++bit) {
+			index |= ((static_cast<std::uint32_t>(indices[bit / 8]) >> (bit % 8)) & 1) << i;
+		}
 
-		scene->erase(item);
+		if (index >= types || lengths[run] > chunk->mTiles.size() - cell) {
+			return nullptr;
+		}
+
+		std::fill_n(chunk->mTiles.begin() + cell, lengths[run], palette[index]);
+		cell += lengths[run];
 	}
-	*/
 
-	for (const auto block : scene->view<Components::block>()) {
-		// Not in the chunk
-		if ((scene->get<Components::block>(block).mPosition.x() / CHUNK_WIDTH -
-		     (scene->get<Components::block>(block).mPosition.x() < 0)) != mPosition) {
-			continue;
+	// Every cell is covered exactly once
+	return cell == chunk->mTiles.size() ? std::move(chunk) : nullptr;
+}
+
+void Chunk::save(utils::snapshot_writer& writer) const {
+	// The types in the order they first show up, and the runs of one type in the column by column order, the
+	// stone under the surface and the air above it are a few runs per column
+	std::vector<tile> palette;
+	std::vector<std::pair<std::uint32_t, std::uint16_t>> runs;
+
+	for (std::size_t begin = 0; begin < mTiles.size();) {
+		const tile type = mTiles[begin];
+		std::size_t end = begin + 1;
+		while (end < mTiles.size() && mTiles[end] == type) {
+			++end;
 		}
 
-		// Here we store the block as type pos pos
-		rapidjson::Value i(rapidjson::kArrayType);
+		const auto index = static_cast<std::uint16_t>(std::ranges::find(palette, type) - palette.begin());
+		if (index == palette.size()) {
+			palette.emplace_back(type);
+		}
+
+		runs.emplace_back(static_cast<std::uint32_t>(end - begin), index);
+		begin = end;
+	}
 
-		i.PushBack(etoi(scene->template get<Components::block>(block).mType), allocator);
-		i.PushBack(fromVector2i(scene->template get<Components::block>(block).mPosition, allocator).Move(),
-			   allocator);
+	const int bits = std::bit_width(palette.size() - 1);
 
-		chunk[BLOCKS_KEY].PushBack(i.Move(), allocator);
+	// Built on the side, the writer grows with every write. Lengths take two bytes at most
+	std::vector<std::uint8_t> body;
+	body.reserve(runs.size() * 2 + (runs.size() * bits + 7) / 8);
 
-		scene->erase(block);
+	for (const auto& [length, index] : runs) {
+		writeLength(body, length);
 	}
+
+	// The palette index of each run, `bits` each, lowest bit first
+	std::uint64_t buffer = 0;
+	int buffered = 0;
+	for (const auto& [length, index] : runs) {
+		buffer |= static_cast<std::uint64_t>(index) << buffered;
+		buffered += bits;
+
+		while (buffered >= 8) {
+			body.emplace_back(static_cast<std::uint8_t>(buffer));
+			buffer >>= 8;
+			buffered -= 8;
+		}
+	}
+
+	if (buffered > 0) {
+		body.emplace_back(static_cast<std::uint8_t>(buffer));
+	}
+
+	writer.reserve(sizeof(FORMAT) + sizeof(mPosition) + 2 * sizeof(std::uint16_t) + palette.size() * sizeof(tile) +
+		       body.size());
+	writer.write(FORMAT);
+	writer.write(mPosition);
+	writer.write(static_cast<std::uint16_t>(palette.size()));
+	writer.bytes(palette.data(), palette.size() * sizeof(tile));
+	writer.write(static_cast<std::uint16_t>(runs.size()));
+	writer.bytes(body.data(), body.size());
 }
 
-void Chunk::spawnStructure(std::vector<std::vector<Components::Item>>& blocks, const Eigen::Vector2i& pos,
-			   const std::vector<std::pair<Components::Item, Eigen::Vector2i>> structure,
-			   Scene* const scene) {
-	const auto& blockView = scene->view<Components::block>();
+void Chunk::spawnStructure(const Eigen::Vector2i& pos,
+			   const std::vector<std::pair<Components::Item, Eigen::Vector2i>>& structure) {
 	for (const auto& [blockType, offset] : structure) {
 		const Eigen::Vector2i realPos = pos + offset;
 
-		if (realPos.x() < 0 || realPos.x() >= CHUNK_WIDTH) {
-			// Lets place in scene
-			const Eigen::Vector2i position = offset + pos + Eigen::Vector2i(mPosition * CHUNK_WIDTH, 0);
+		SDL_assert(registers::BREAK_TIMES.contains(blockType) && "The block to be placed isn't brakable!");
 
-			bool occupied = false;
-			for (const auto block : blockView) {
-				if (scene->get<Components::block>(block).mPosition == position) {
-					occupied = true;
-					break;
-				}
-			}
+		// The neighbour places its own part
+		if (realPos.x() >= 0 && realPos.x() < CHUNK_WIDTH && realPos.y() >= 0 && realPos.y() < MAX_HEIGHT &&
+		    at(realPos.x(), realPos.y()) == 0) {
+			at(realPos.x(), realPos.y()) = static_cast<tile>(blockType);
+		}
+	}
+}
 
-			if (occupied) {
-				continue;
-			}
+void Chunk::carve(const class NoiseGenerator* const noise) {
+	std::array<float, MAX_HEIGHT> cave;
 
-			SDL_assert(registers::BREAK_TIMES.contains(blockType) &&
-				   "The block to be placed isn't brakable!");
-
-			Texture* const texture =
-				Game::getInstance()->getSystemManager()->getTexture(registers::TEXTURES.at(blockType));
-			const EntityID entity = scene->newEntity();
-			scene->emplace<Components::block>(entity, blockType, position);
-			scene->emplace<Components::texture>(entity, texture);
-
-			if (registers::COLLISION_BOXES.contains(blockType)) {
-				const auto& collision = registers::COLLISION_BOXES.at(blockType);
-				scene->emplace<Components::collision>(entity, collision.first, collision.second, true);
-			} else {
-				scene->emplace<Components::collision>(entity, Eigen::Vector2f(0.0f, 0.0f),
-								      texture->getSize(), true);
-			}
-		} else {
-			if (blocks[realPos.x()][realPos.y()] == Components::AIR()) {
-				blocks[realPos.x()][realPos.y()] = blockType;
+	for (int x = 0; x < CHUNK_WIDTH; ++x) {
+		const int roof = static_cast<int>(mHeightMap[x]) - CAVE_ROOF;
+		if (roof <= CAVE_FLOOR) {
+			continue;
+		}
+
+		const auto column = std::span(cave).first(roof);
+		noise->getNoise(NoiseGenerator::Feature::CAVE, mPosition * CHUNK_WIDTH + x, 0, column, CAVES);
+
+		for (int y = CAVE_FLOOR; y < roof; ++y) {
+			const bool stone = at(x, y) == static_cast<tile>(Components::Item::STONE);
+			if (stone && std::abs(column[y]) < CAVE_WIDTH) {
+				at(x, y) = static_cast<tile>(Components::Item::AIR);
 			}
 		}
 	}
 }
 
-void Chunk::carve(std::vector<std::vector<Components::Item>>& blocks, class NoiseGenerator* const noise) {
-	// TODO: Cave carver
-	(void)noise;
-	(void)blocks;
-}
-
-void Chunk::spawnOres(std::vector<std::vector<Components::Item>>& blocks, class NoiseGenerator* const noise) {
+void Chunk::spawnOres(const class NoiseGenerator* const noise) {
 	const static Eigen::Vector2f dir[] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+	using Feature = NoiseGenerator::Feature;
 
-	// Spawn ores here
+	// Spawn ores here, every roll is keyed on the block in world space
+	// The ore noise makes some stone richer than the rest, as often as poorer, so there are as many veins overall
+	const auto offset = mPosition * CHUNK_WIDTH;
+	std::array<float, WATER_LEVEL * 2> richness;
 	for (std::uint64_t x = 0; x < CHUNK_WIDTH; x += 2) {
+		const std::int64_t worldX = x + offset;
+		noise->getNoise(Feature::ORE, worldX, 0, richness, ORES);
+
 		for (std::uint64_t y = 0; y < WATER_LEVEL * 2; y += 2) {
-			if (blocks[x][y] != Components::Item::STONE) {
+			if (at(x, y) != static_cast<tile>(Components::Item::STONE)) {
 				continue;
 			}
 
 			// Roll
-			for (const auto& vein : registers::VEINS) {
+			const float chance = std::max(1.0f + 2.0f * richness[y], 0.0f);
+			for (std::uint32_t kind = 0; kind < registers::VEINS.size(); ++kind) {
+				const auto& vein = registers::VEINS[kind];
 				if (y >= std::get<1>(vein)) {
 					continue;
 				}
 
-				if (noise->randf() >= std::get<0>(vein)) {
+				if (noise->randf(worldX, y, Feature::VEIN, kind) >= chance * std::get<0>(vein)) {
 					continue;
 				}
 
 				const auto ore = std::get<2>(vein);
-				const auto count = std::get<3>(vein) + static_cast<int>(4 * noise->randf() - 0.25f);
+				const float size = noise->randf(worldX, y, Feature::VEIN_SIZE, kind);
+				const auto count = std::get<3>(vein) + static_cast<int>(4 * size - 0.25f);
 
 				// Now we need to spawn
 				Eigen::Vector2f pos(x, y);
 				for (std::uint64_t c = 0; c < count; ++c) {
-					pos += dir[static_cast<int>(static_cast<int>(count / 3) * noise->randf())];
+					const float step = noise->randf(worldX, y, Feature::VEIN_STEP, kind << 16 | c);
+					pos += dir[static_cast<int>(static_cast<int>(count / 3) * step)];
 					if (pos.x() < 0) {
 						pos.x() = 0;
 					}
@@ -259,11 +366,11 @@ void Chunk::spawnOres(std::vector<std::vector<Components::Item>>& blocks, class
 						pos.y() = WATER_LEVEL * 2 - 1;
 					}
 
-					if (blocks[pos.x()][pos.y()] != Components::Item::STONE) {
+					if (at(pos.x(), pos.y()) != static_cast<tile>(Components::Item::STONE)) {
 						continue;
 					}
 
-					blocks[pos.x()][pos.y()] = ore;
+					at(pos.x(), pos.y()) = static_cast<tile>(ore);
 				}
 
 				break;
@@ -6,8 +6,12 @@
 #include "components/playerInventory.hpp"
 #include "game.hpp"
 #include "managers/entityManager.hpp"
+#include "managers/storageManager.hpp"
 #include "managers/systemManager.hpp"
+#include "misc/snapshot.hpp"
+#include "misc/thread_pool.hpp"
 #include "opengl/texture.hpp"
+#include "registers.hpp"
 #include "scene.hpp"
 #include "scenes/chunk.hpp"
 #include "systems/UISystem.hpp"
@@ -17,14 +21,28 @@
 #include "third_party/rapidjson/rapidjson.h"
 
 #include <SDL3/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef IMGUI
+#include "imgui.h"
+#endif
 
 Level::Level(const std::string& name)
-	: mName(name), mTextID(0), mLeft(nullptr), mCenter(nullptr), mRight(nullptr), mGame(Game::getInstance()),
-	  mScene(nullptr), mNoise(new NoiseGenerator()) {}
+	: mName(name), mTextID(0), mFresh(false), mCenter(0), mRenderRadius(RENDER_RADIUS),
+	  mSimulationRadius(SIMULATION_RADIUS), mRendered(RENDER_RADIUS),
+	  mRadius(std::max(RENDER_RADIUS, SIMULATION_RADIUS)), mUnloaded(CACHE_BUDGET),
+	  mGame(Game::getInstance()),
+	  mScene(nullptr), mNoise(new NoiseGenerator()), mGenerated(std::make_shared<generated>()), mStats(),
+	  mRevision(++sRevision) {}
 
 Level::~Level() {
 	SDL_Log("Unloading level");
@@ -43,20 +61,35 @@ void Level::create() {
 
 	mScene->emplace<Components::velocity>(player, Eigen::Vector2f(0.0f, 0.0f));
 	mScene->emplace<Components::position>(
-		player, Eigen::Vector2f(0.0f, (Chunk::WATER_LEVEL + 1 + (5 * mNoise->getNoise(0))) *
+		player, Eigen::Vector2f(0.0f, static_cast<float>(Chunk::surfaceOf(mNoise.get(), 0) + 1) *
 						      Components::block::BLOCK_SIZE));
 	mScene->emplace<Components::inventory>(player, new PlayerInventory(mGame, 36));
 
-    mLeft = new Chunk(mScene.get(), mNoise.get(), -1);
-    mCenter = new Chunk(mScene.get(), mNoise.get(), 0);
-    mRight = new Chunk(mScene.get(), mNoise.get(), 1);
-
 	mData.AddMember(rapidjson::StringRef(CHUNK_KEY), rapidjson::Value(rapidjson::kObjectType),
 			mData.GetAllocator());
 	mData.AddMember(rapidjson::StringRef(PLAYER_KEY), rapidjson::Value(rapidjson::kObjectType),
 			mData.GetAllocator());
-	mData[CHUNK_KEY].AddMember("-", rapidjson::Value(rapidjson::kArrayType), mData.GetAllocator());
-	mData[CHUNK_KEY].AddMember("+", rapidjson::Value(rapidjson::kArrayType), mData.GetAllocator());
+
+	// A new world, the regions of the old one would be loaded over the new terrain. They are only deleted once this
+	// one is saved, the old world may just have failed to load
+	const std::string world = StorageManager::getRegionPath();
+	std::string directory;
+	for (std::size_t i = 0; directory.empty() || SDL_GetPathInfo((world + directory).data(), nullptr); ++i) {
+		directory = std::string(REGIONS_KEY) + "." + std::to_string(i);
+	}
+
+	mRegionPath = world + directory + "/";
+	mFresh = true;
+	if (!SDL_CreateDirectory(mRegionPath.data())) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "\033[31mFailed to create %s: %s\033[0m", mRegionPath.data(),
+			     SDL_GetError());
+	}
+
+	mData[CHUNK_KEY].AddMember(rapidjson::StringRef(REGIONS_KEY),
+				   rapidjson::Value(directory.data(), mData.GetAllocator()).Move(),
+				   mData.GetAllocator());
+
+	shift(0);
 
 	SDL_assert(mData.HasMember(PLAYER_KEY));
 	SDL_assert(mData.HasMember(CHUNK_KEY));
@@ -80,32 +113,25 @@ void Level::load(rapidjson::Value& data) {
 	mScene->emplace<Components::velocity>(player, getVector2f(mData[PLAYER_KEY]["velocity"]));
 	mScene->emplace<Components::inventory>(player, new PlayerInventory(mGame, mData[PLAYER_KEY]["inventory"]));
 
-	const auto loadChunk = [this](Chunk*& chunk, const float playerPos) {
-		const auto sign = playerPos < 0;
-		const auto centerChunk =
-			static_cast<int>(playerPos) / Components::block::BLOCK_SIZE / Chunk::CHUNK_WIDTH - sign;
-
-		if (this->mData[CHUNK_KEY][sign ? "-" : "+"][SDL_abs(centerChunk)].IsNull()) {
-			SDL_Log("Chunk %d was Null! Making new chunk", centerChunk);
-            chunk = new Chunk(this->mScene.get(), mNoise.get(), centerChunk);
-
-			return;
-		}
-
-        chunk = new Chunk(this->mData[CHUNK_KEY][sign ? "-" : "+"][SDL_abs(centerChunk)], this->mScene.get());
-	};
-
 	const auto playerPos = getVector2f(mData[PLAYER_KEY]["position"]).x();
 	mScene->mMouse.count = mData[PLAYER_KEY]["mcount"].GetUint64();
 	mScene->mMouse.item = static_cast<Components::Item>(mData[PLAYER_KEY]["mitem"].GetUint64());
 
-	loadChunk(mCenter, playerPos);
-	loadChunk(mLeft, playerPos - Chunk::CHUNK_WIDTH * Components::block::BLOCK_SIZE + 0.1);
-	loadChunk(mRight, playerPos + Chunk::CHUNK_WIDTH * Components::block::BLOCK_SIZE + 0.1);
+	// Worlds from before each level had its own directory keep the regions in the world one
+	mRegionPath = StorageManager::getRegionPath();
+	if (mData[CHUNK_KEY].HasMember(REGIONS_KEY)) {
+		mRegionPath += std::string(mData[CHUNK_KEY][REGIONS_KEY].GetString()) + "/";
+	}
+	mFresh = false;
+	migrate();
+
+	shift(chunkOf(playerPos));
 }
 
 void Level::save(rapidjson::Value& data, rapidjson::MemoryPoolAllocator<>& allocator) {
 	SDL_Log("Saving level");
+	SDL_Log("Chunk prefetch: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " cancelled", mStats.hits,
+		mStats.misses, mStats.cancelled);
 	const auto playerID = mGame->getPlayerID();
 
 	if (!mData[PLAYER_KEY].HasMember("position")) {
@@ -153,29 +179,48 @@ void Level::save(rapidjson::Value& data, rapidjson::MemoryPoolAllocator<>& alloc
 
 	mScene->erase(playerID);
 
-	const auto save = [this](Chunk* chunk) {
-		SDL_assert(chunk != nullptr);
-
-		while (this->mData[CHUNK_KEY][chunk->getPosition() < 0 ? "-" : "+"].Size() <=
-		       std::llabs(chunk->getPosition())) {
-			this->mData[CHUNK_KEY][chunk->getPosition() < 0 ? "-" : "+"].PushBack(
-				rapidjson::Value(rapidjson::kArrayType).SetObject().Move(), this->mData.GetAllocator());
+	// Only the chunks that changed, the others are the same in the region files already
+	for (const auto& [position, chunk] : mChunks) {
+		if (chunk->dirty()) {
+			store(position, encode(*chunk));
 		}
+	}
+	mChunks.clear();
+	mUnloaded.clear([this](const std::int64_t position, const unloaded& chunk) { evict(position, chunk); });
+	mRegions.clear();
+
+	data.CopyFrom(mData.Move(), allocator);
+}
+
+void Level::dropOldRegions() {
+	if (!mFresh) {
+		return;
+	}
+	mFresh = false;
 
-		this->mData[CHUNK_KEY][chunk->getPosition() < 0 ? "-" : "+"][SDL_abs(chunk->getPosition())].SetObject();
+	// Loose in the world directory from before the levels had their own
+	const std::string world = StorageManager::getRegionPath();
+	Region::removeAll(world);
 
-        chunk->save(this->mScene.get(),
-			    this->mData[CHUNK_KEY][chunk->getPosition() < 0 ? "-" : "+"][SDL_abs(chunk->getPosition())],
-			    this->mData.GetAllocator());
+	int count = 0;
+	char** const directories = SDL_GlobDirectory(world.data(), (std::string(REGIONS_KEY) + ".*").data(), 0, &count);
+	if (directories == nullptr) {
+		return;
+	}
 
-		delete chunk;
-	};
+	for (int i = 0; i < count; ++i) {
+		const std::string directory = world + directories[i] + "/";
+		if (directory == mRegionPath) {
+			continue;
+		}
 
-	save(mLeft);
-	save(mCenter);
-	save(mRight);
+		Region::removeAll(directory);
+		if (!SDL_RemovePath(directory.data())) {
+			SDL_Log("\033[33mFailed to remove old regions %s: %s\033[0m", directories[i], SDL_GetError());
+		}
+	}
 
-	data.CopyFrom(mData.Move(), allocator);
+	SDL_free(directories);
 }
 
 void Level::update(const float delta) {
@@ -189,78 +234,28 @@ void Level::update(const float delta) {
 
 	const auto playerID = mGame->getPlayerID();
 
-	const auto playerX = static_cast<int>(mScene->get<Components::position>(playerID).mPosition.x());
-	const auto sign = playerX < 0;
-	const auto currentChunk = playerX / Components::block::BLOCK_SIZE / Chunk::CHUNK_WIDTH - sign;
+	const auto currentChunk = chunkOf(mScene->get<Components::position>(playerID).mPosition.x());
 
-	// Now, we need to check if we need to load a chunk
-	if (currentChunk == mCenter->getPosition()) {
-		return;
-	}
+	collect();
 
-	const auto pad = [this](std::int64_t position) {
-		while (this->mData[CHUNK_KEY][position < 0 ? "-" : "+"].Size() <= std::llabs(position)) {
-			this->mData[CHUNK_KEY][position < 0 ? "-" : "+"].PushBack(
-				rapidjson::Value(rapidjson::kArrayType).SetObject().Move(), this->mData.GetAllocator());
-		}
-	};
-
-	const auto save = [this, &pad](Chunk* chunk) {
-		pad(chunk->getPosition());
-
-		this->mData[CHUNK_KEY][chunk->getPosition() < 0 ? "-" : "+"][SDL_abs(chunk->getPosition())].SetObject();
-
-        chunk->save(this->mScene.get(),
-			    this->mData[CHUNK_KEY][chunk->getPosition() < 0 ? "-" : "+"][SDL_abs(chunk->getPosition())],
-			    this->mData.GetAllocator());
-
-		delete chunk;
-	};
-
-	if (currentChunk == mLeft->getPosition()) {
-		save(mRight);
-
-		mRight = mCenter;
-		mCenter = mLeft;
-
-		pad(currentChunk - 1);
-		const auto& chunkData = mData[CHUNK_KEY][(currentChunk - 1) < 0 ? "-" : "+"][SDL_abs(currentChunk - 1)];
-		if (chunkData.IsNull() || !chunkData.HasMember("blocks")) {
-			SDL_LogInfo(SDL_LOG_CATEGORY_CUSTOM, "\033[31mGenerating new chunk for chunk %d\033[0m",
-				    currentChunk - 1);
-
-            mLeft = new Chunk(mScene.get(), mNoise.get(), currentChunk - 1);
-		} else {
-            mLeft = new Chunk(chunkData, mScene.get());
-		}
-	} else if (currentChunk == mRight->getPosition()) {
-		save(mLeft);
-
-		mLeft = mCenter;
-		mCenter = mRight;
-
-		pad(currentChunk + 1);
-		const auto& chunkData = mData[CHUNK_KEY][(currentChunk + 1) < 0 ? "-" : "+"][SDL_abs(currentChunk + 1)];
-		if (chunkData.IsNull() || !chunkData.HasMember("blocks")) {
-			SDL_LogInfo(SDL_LOG_CATEGORY_CUSTOM, "\033[31mGenerating new chunk for chunk %d\033[0m",
-				    currentChunk + 1);
-
-            mRight = new Chunk(mScene.get(), mNoise.get(), currentChunk + 1);
-		} else {
-            mRight = new Chunk(chunkData, mScene.get());
-		}
+#ifdef IMGUI
+	ImGui::Begin("Developer menu");
+	int render = static_cast<int>(mRenderRadius);
+	int simulation = static_cast<int>(mSimulationRadius);
+	const bool edited = ImGui::SliderInt("Render distance", &render, 0, 16);
+	if (ImGui::SliderInt("Simulation distance", &simulation, 0, 16) || edited) {
+		setRadius(render, simulation);
+	}
+	ImGui::Text("Prefetch: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " cancelled", mStats.hits,
+		    mStats.misses, mStats.cancelled);
+	ImGui::End();
+#endif
+
+	// Now, we need to check if we need to load a chunk, or the window grew past the loaded ones
+	if (currentChunk != mCenter || std::max(mRenderRadius, windowRadius()) != mRendered) {
+		shift(currentChunk);
 	} else {
-		SDL_Log("\033[33mOut of boundary for chunk %d, loaded chunks: %" PRIi64 " %" PRIi64 " %" PRIi64
-			"\033[0m",
-			currentChunk, mLeft->getPosition(), mCenter->getPosition(), mRight->getPosition());
-
-		save(mLeft);
-		save(mCenter);
-		save(mRight);
-
-        mLeft = new Chunk(mScene.get(), mNoise.get(), currentChunk - 1);
-        mCenter = new Chunk(mScene.get(), mNoise.get(), currentChunk);
-        mRight = new Chunk(mScene.get(), mNoise.get(), currentChunk + 1);
+		prefetch();
 	}
 }
 
@@ -271,20 +266,21 @@ void Level::createCommon() {
 	mScene->emplace<Components::collision>(
 		player, Eigen::Vector2f(4.0f * 7.0f, 0.0f),
 		Eigen::Vector2f(Components::block::BLOCK_SIZE, Components::block::BLOCK_SIZE));
-	mScene->emplace<Components::misc>(player, Components::misc::JUMP | Components::misc::PLAYER);
+	mScene->emplace<Components::jump>(player);
+	mScene->emplace<Components::player>(player);
 	mScene->emplace<Components::input>(player, [](class Scene* scene, const EntityID entity, const float) {
 		Eigen::Vector2f& vel = scene->get<Components::velocity>(entity).mVelocity;
 
-		if (scene->getSignal(SDL_SCANCODE_D) && vel.x() < 340) {
+		if (scene->events().pressed(SDL_SCANCODE_D) && vel.x() < 340) {
 			vel.x() += 100;
 		}
 
-		if (scene->getSignal(SDL_SCANCODE_A) && vel.x() > -340) {
+		if (scene->events().pressed(SDL_SCANCODE_A) && vel.x() > -340) {
 			vel.x() -= 100;
 		}
 
 		// Open inv
-		if (scene->getSignal(SDL_SCANCODE_E)) {
+		if (scene->events().pressed(SDL_SCANCODE_E)) {
 			Game::getInstance()->getSystemManager()->getUISystem()->addScreen(
 				scene->get<Components::inventory>(entity).mInventory);
 		}
@@ -296,4 +292,311 @@ void Level::createCommon() {
 								       std::numeric_limits<float>::infinity()));
 }
 
-std::int64_t Level::getPosition() { return mCenter->getPosition(); }
+void Level::setRadius(const std::int64_t render, const std::int64_t simulation) {
+	mRenderRadius = std::max<std::int64_t>(render, 0);
+	mSimulationRadius = std::max<std::int64_t>(simulation, 0);
+
+	// Before `create` or `load` there is nothing to move yet
+	if (mScene != nullptr) {
+		shift(mCenter);
+	}
+}
+
+Components::Item Level::blockAt(const Eigen::Vector2i& position) const {
+	const Chunk* const chunk = getChunk(position.x());
+
+	return chunk == nullptr ? Components::AIR() : chunk->getBlock(position);
+}
+
+bool Level::setBlock(const Eigen::Vector2i& position, const Components::Item type) {
+	Chunk* const chunk = getChunk(position.x());
+	if (chunk == nullptr || !chunk->contains(position)) {
+		return false;
+	}
+
+	chunk->setBlock(position, type);
+	chunk->setDirty(true);
+	changed();
+
+	return true;
+}
+
+Chunk* Level::getChunk(const std::int64_t x) const {
+	const auto chunk = mChunks.find(Chunk::chunkOf(x));
+
+	return chunk == mChunks.end() ? nullptr : chunk->second.get();
+}
+
+std::int64_t Level::chunkOf(const float x) {
+	// Truncated like the chunk the player was saved in
+	const auto block = static_cast<int>(x) / Components::block::BLOCK_SIZE;
+
+	return block / Chunk::CHUNK_WIDTH - (x < 0);
+}
+
+Region& Level::region(const std::int64_t position) {
+	const auto index = Region::regionOf(position);
+
+	auto& region = mRegions[index];
+	if (region == nullptr) {
+		region = std::make_unique<Region>(Region::pathOf(mRegionPath, index));
+	}
+
+	return *region;
+}
+
+std::unique_ptr<Chunk> Level::readChunk(const std::int64_t position) {
+	const auto data = region(position).read(position);
+	if (data.empty()) {
+		return nullptr;
+	}
+
+	return decode(position, data);
+}
+
+std::vector<std::byte> Level::encode(const Chunk& chunk) {
+	utils::snapshot_writer writer;
+	chunk.save(writer);
+
+	return writer.release();
+}
+
+std::unique_ptr<Chunk> Level::decode(const std::int64_t position, const std::span<const std::byte> data) {
+	auto chunk = Chunk::load(data);
+	if (chunk == nullptr || chunk->getPosition() != position) {
+		SDL_Log("\033[33mSaved chunk %" PRIi64 " is broken, generating it again\033[0m", position);
+
+		return nullptr;
+	}
+
+	return chunk;
+}
+
+void Level::migrate() {
+	auto& chunks = mData[CHUNK_KEY];
+
+	for (const char* const side : {"-", "+"}) {
+		if (!chunks.HasMember(side)) {
+			continue;
+		}
+
+		for (const auto& data : chunks[side].GetArray()) {
+			if (data.IsObject() && data.HasMember("blocks")) {
+				const Chunk chunk(data);
+				store(chunk.getPosition(), encode(chunk));
+			}
+		}
+
+		chunks.RemoveMember(side);
+	}
+}
+
+std::int64_t Level::windowRadius() const {
+	constexpr const static float width = Chunk::CHUNK_WIDTH * Components::block::BLOCK_SIZE;
+
+	// The camera is centered on the player, who can stand anywhere in the center chunk
+	return static_cast<std::int64_t>(SDL_ceilf(mGame->getSystemManager()->getDemensions().x() / 2 / width));
+}
+
+void Level::shift(const std::int64_t center) {
+	mRendered = std::max(mRenderRadius, windowRadius());
+	const std::int64_t radius = std::max(mRendered, mSimulationRadius);
+
+	// Dropped first, a jump further than the radius doesn't keep both sets around
+	std::vector<std::int64_t> left;
+	for (const auto& [position, chunk] : mChunks) {
+		if (std::llabs(position - center) > radius) {
+			left.emplace_back(position);
+		}
+	}
+
+	for (const auto position : left) {
+		unloadChunk(position);
+	}
+
+	// Nearest first, so the player's own chunk is there even if the others take a while
+	for (std::int64_t distance = 0; distance <= radius; ++distance) {
+		for (const auto position : {center - distance, center + distance}) {
+			if (!mChunks.contains(position)) {
+				loadChunk(position);
+			}
+		}
+	}
+
+	// The rendered and simulated chunks moved even if none were loaded
+	mCenter = center;
+	mRadius = radius;
+	changed();
+
+	prefetch();
+}
+
+Chunk* Level::loadChunk(const std::int64_t position) {
+	SDL_assert(!mChunks.contains(position));
+
+	// Only counted once the chunk is settled, a broken save that gets generated again is a single miss
+	bool hit = false;
+
+	std::unique_ptr<Chunk> chunk;
+	if (const auto cached = mUnloaded.take(position)) {
+		chunk = decode(position, cached->data);
+		hit = chunk != nullptr;
+
+		if (chunk != nullptr) {
+			chunk->setDirty(cached->dirty);
+		}
+	} else if (saved(position)) {
+		chunk = readChunk(position);
+	}
+
+	// Never saved, or the save is broken
+	if (chunk == nullptr) {
+		if (const auto ready = mReady.find(position); ready != mReady.end()) {
+			chunk = std::move(ready->second);
+			mReady.erase(ready);
+			hit = true;
+		} else {
+			SDL_LogInfo(SDL_LOG_CATEGORY_CUSTOM,
+				    "\033[31mGenerating new chunk for chunk %" PRIi64 " on the main thread\033[0m",
+				    position);
+
+			chunk = generate(position);
+		}
+	}
+
+	++(hit ? mStats.hits : mStats.misses);
+
+	Chunk* const loaded = chunk.get();
+	mChunks.emplace(position, std::move(chunk));
+	changed();
+
+	return loaded;
+}
+
+void Level::unloadChunk(const std::int64_t position) {
+	const auto chunk = mChunks.find(position);
+	SDL_assert(chunk != mChunks.end());
+
+	cache(position, encode(*chunk->second), chunk->second->dirty());
+
+	mChunks.erase(chunk);
+	changed();
+}
+
+void Level::cache(const std::int64_t position, std::vector<std::byte> data, const bool dirty) {
+	const auto memory = data.capacity();
+
+	mUnloaded.put(position, unloaded{std::move(data), dirty}, memory,
+		      [this](const std::int64_t evicted, const unloaded& chunk) { evict(evicted, chunk); });
+}
+
+void Level::store(const std::int64_t position, const std::span<const std::byte> data) {
+	if (!region(position).write(position, data)) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "\033[31mFailed to save chunk %" PRIi64 "\033[0m", position);
+	}
+}
+
+void Level::evict(const std::int64_t position, const unloaded& chunk) {
+	if (chunk.dirty) {
+		store(position, chunk.data);
+	}
+}
+
+std::unique_ptr<Chunk> Level::generate(const std::int64_t position) {
+	return std::make_unique<Chunk>(mNoise.get(), position);
+}
+
+void Level::prefetch() {
+	constexpr const static float width = Chunk::CHUNK_WIDTH * Components::block::BLOCK_SIZE;
+
+	const auto player = mGame->getPlayerID();
+	const float x = mScene->get<Components::position>(player).mPosition.x();
+	const float velocity = mScene->get<Components::velocity>(player).mVelocity.x();
+	const float ahead = x + velocity * PREFETCH_TIME;
+
+	// Where the player can be in `PREFETCH_TIME`, and the radius around it
+	const std::int64_t from = chunkOf(std::min(x, ahead)) - mRadius - PREFETCH_DISTANCE;
+	const std::int64_t to = chunkOf(std::max(x, ahead)) + mRadius + PREFETCH_DISTANCE;
+	const auto stale = [from, to](const std::int64_t position) { return position < from || position > to; };
+
+	// The player turned around before they were needed, they come out the same if generated again
+	std::erase_if(mRequested, [this, &stale](const auto& requested) {
+		if (!stale(requested.first)) {
+			return false;
+		}
+
+		requested.second->store(true, std::memory_order_relaxed);
+		++mStats.cancelled;
+
+		return true;
+	});
+	std::erase_if(mReady, [&stale](const auto& ready) { return stale(ready.first); });
+
+	// When each chunk comes within the radius, a chunk behind the player only comes by drifting back
+	std::vector<std::pair<float, std::int64_t>> wanted;
+	for (std::int64_t position = from; position <= to; ++position) {
+		if (mChunks.contains(position) || mRequested.contains(position) || mReady.contains(position) ||
+		    mUnloaded.contains(position)) {
+			continue;
+		}
+
+		const float edge = position < mCenter ? (position + 1 + mRadius) * width : (position - mRadius) * width;
+		const float gap = std::max(position < mCenter ? x - edge : edge - x, 0.0f);
+		const float towards = position < mCenter ? -velocity : velocity;
+
+		wanted.emplace_back(gap / std::max(towards, PREFETCH_DRIFT), position);
+	}
+
+	std::ranges::sort(wanted);
+
+	std::size_t loads = 0;
+	for (const auto& [time, position] : wanted) {
+		if (saved(position)) {
+			// Only the main thread touches the region files, saved chunks are copied here, a few per frame
+			if (loads < PREFETCH_LOADS) {
+				++loads;
+
+				const auto data = region(position).read(position);
+				cache(position, std::vector<std::byte>(data.begin(), data.end()), false);
+			}
+		} else if (mRequested.size() < PREFETCH_JOBS) {
+			request(position);
+		}
+	}
+}
+
+void Level::request(const std::int64_t position) {
+	const auto cancelled = std::make_shared<std::atomic<bool>>(false);
+	mRequested.emplace(position, cancelled);
+
+	// Only the heights, grid, structures and ores. The noise is a copy so nothing is shared with the main thread,
+	// and as it has no state the chunk comes out the same as one generated right here
+	utils::thread_pool::getInstance()->submit(
+		[results = mGenerated, cancelled, noise = *mNoise, position]() {
+			if (cancelled->load(std::memory_order_relaxed)) {
+				return;
+			}
+
+			auto chunk = std::make_unique<Chunk>(&noise, position);
+
+			std::lock_guard lock(results->mutex);
+			results->chunks.emplace_back(std::move(chunk));
+		});
+}
+
+void Level::collect() {
+	std::vector<std::unique_ptr<Chunk>> chunks;
+	{
+		std::lock_guard lock(mGenerated->mutex);
+		chunks.swap(mGenerated->chunks);
+	}
+
+	for (auto& chunk : chunks) {
+		const auto position = chunk->getPosition();
+
+		// Cancelled once it was already running, or needed before it was done and generated on the main thread
+		if (mRequested.erase(position) != 0 && !mChunks.contains(position)) {
+			mReady.emplace(position, std::move(chunk));
+		}
+	}
+}
@@ -0,0 +1,286 @@
+#include "scenes/region.hpp"
+
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// No mmap on Windows and the web, the chunks are read with the stream there
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define REGION_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Region::Region(const std::string& path)
+	: mPath(path), mFile(nullptr), mWritable(false), mBroken(false), mEntries(), mSectors(0), mMapping(nullptr),
+	  mMappingSize(0) {
+	// Looking for a chunk opens the regions around the player, that mustn't leave empty files behind
+	if (!SDL_GetPathInfo(mPath.data(), nullptr)) {
+		return;
+	}
+
+	mFile = SDL_IOFromFile(mPath.data(), "rb");
+	if (mFile == nullptr || !readHeader()) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "\033[31mFailed to open region file %s: %s\033[0m",
+			     mPath.data(), SDL_GetError());
+
+		if (mFile != nullptr) {
+			SDL_CloseIO(mFile);
+			mFile = nullptr;
+		}
+		mBroken = true;
+		mEntries = {};
+	}
+}
+
+Region::~Region() {
+	unmap();
+
+	if (mFile != nullptr) {
+		SDL_CloseIO(mFile);
+	}
+}
+
+std::string Region::pathOf(const std::string& directory, const std::int64_t region) {
+	return directory + "r." + std::to_string(region) + ".region";
+}
+
+void Region::removeAll(const std::string& directory) {
+	int count = 0;
+	char** const files = SDL_GlobDirectory(directory.data(), "r.*.region", 0, &count);
+	if (files == nullptr) {
+		return;
+	}
+
+	for (int i = 0; i < count; ++i) {
+		if (!SDL_RemovePath((directory + files[i]).data())) {
+			SDL_Log("\033[33mFailed to remove old region file %s: %s\033[0m", files[i], SDL_GetError());
+		}
+	}
+
+	SDL_free(files);
+}
+
+std::span<const std::byte> Region::read(const std::int64_t chunk) {
+	const entry& saved = mEntries[slot(chunk)];
+	if (mFile == nullptr || saved.size == 0) {
+		return {};
+	}
+
+	const std::uint64_t offset = saved.sector * SECTOR_SIZE;
+
+	if (mMapping == nullptr) {
+		map();
+	}
+	if (mMapping != nullptr && offset + saved.size <= mMappingSize) {
+		return {mMapping + offset, saved.size};
+	}
+
+	mBuffer.resize(saved.size);
+	if (SDL_SeekIO(mFile, static_cast<Sint64>(offset), SDL_IO_SEEK_SET) < 0 ||
+	    SDL_ReadIO(mFile, mBuffer.data(), mBuffer.size()) != mBuffer.size()) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+			     "\033[31mFailed to read chunk %" PRIi64 " from %s: %s\033[0m", chunk, mPath.data(),
+			     SDL_GetError());
+
+		return {};
+	}
+
+	return mBuffer;
+}
+
+bool Region::write(const std::int64_t chunk, const std::span<const std::byte> data) {
+	if (data.empty() || !writable()) {
+		return false;
+	}
+
+	const std::size_t index = slot(chunk);
+	const auto sectors = static_cast<std::uint32_t>((data.size() + SECTOR_SIZE - 1) / SECTOR_SIZE);
+	const std::uint32_t sector =
+		sectors <= mEntries[index].sectors ? mEntries[index].sector : allocate(index, sectors);
+
+	// Padded to whole sectors, so the file always ends on one
+	const static std::vector<std::byte> padding(SECTOR_SIZE);
+	const std::size_t pad = sectors * SECTOR_SIZE - data.size();
+
+	if (SDL_SeekIO(mFile, static_cast<Sint64>(sector * SECTOR_SIZE), SDL_IO_SEEK_SET) < 0 ||
+	    SDL_WriteIO(mFile, data.data(), data.size()) != data.size() ||
+	    SDL_WriteIO(mFile, padding.data(), pad) != pad) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "\033[31mFailed to write chunk %" PRIi64 " to %s: %s\033[0m",
+			     chunk, mPath.data(), SDL_GetError());
+
+		return false;
+	}
+
+	mEntries[index] = {sector, sectors, static_cast<std::uint32_t>(data.size())};
+	if (!writeEntry(index) || !SDL_FlushIO(mFile)) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+			     "\033[31mFailed to write the header of %s for chunk %" PRIi64 ": %s\033[0m", mPath.data(),
+			     chunk, SDL_GetError());
+
+		return false;
+	}
+
+	// The map still sees the sectors written in place, but not past its end
+	if (sector + sectors > mSectors) {
+		mSectors = sector + sectors;
+		unmap();
+	}
+
+	return true;
+}
+
+bool Region::create() {
+	mFile = SDL_IOFromFile(mPath.data(), "w+b");
+	if (mFile == nullptr) {
+		return false;
+	}
+
+	const std::vector<std::byte> header(SECTOR_SIZE);
+	if (SDL_WriteIO(mFile, header.data(), header.size()) != header.size() ||
+	    SDL_SeekIO(mFile, 0, SDL_IO_SEEK_SET) < 0 || !SDL_WriteU32LE(mFile, MAGIC) ||
+	    !SDL_WriteU32LE(mFile, VERSION) || !SDL_FlushIO(mFile)) {
+		return false;
+	}
+
+	mSectors = 1;
+
+	return true;
+}
+
+bool Region::writable() {
+	if (mWritable) {
+		return true;
+	}
+
+	if (mBroken) {
+		return false;
+	}
+
+	if (mFile == nullptr) {
+		mWritable = create();
+	} else {
+		// The header read before still holds, nothing else writes the file
+		SDL_CloseIO(mFile);
+		mFile = SDL_IOFromFile(mPath.data(), "r+b");
+		mWritable = mFile != nullptr;
+		// Never created over, that would lose the chunks in it
+		mBroken = !mWritable;
+	}
+
+	if (!mWritable) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+			     "\033[31mFailed to open region file %s for writing: %s\033[0m", mPath.data(),
+			     SDL_GetError());
+
+		if (mFile != nullptr) {
+			SDL_CloseIO(mFile);
+			mFile = nullptr;
+		}
+	}
+
+	return mWritable;
+}
+
+bool Region::readHeader() {
+	const Sint64 size = SDL_GetIOSize(mFile);
+	std::uint32_t magic = 0;
+	std::uint32_t version = 0;
+
+	if (size < static_cast<Sint64>(SECTOR_SIZE) || !SDL_ReadU32LE(mFile, &magic) ||
+	    !SDL_ReadU32LE(mFile, &version) || magic != MAGIC || version != VERSION) {
+		SDL_SetError("Not a region file, or from another version");
+
+		return false;
+	}
+
+	mSectors = static_cast<std::uint32_t>(static_cast<std::uint64_t>(size) / SECTOR_SIZE);
+
+	for (std::size_t i = 0; i < mEntries.size(); ++i) {
+		auto& [sector, sectors, bytes] = mEntries[i];
+		if (!SDL_ReadU32LE(mFile, &sector) || !SDL_ReadU32LE(mFile, &sectors) ||
+		    !SDL_ReadU32LE(mFile, &bytes)) {
+			return false;
+		}
+
+		// Cut short by a crash, the chunk is generated again
+		if (bytes != 0 && (sector == 0 || sector + sectors > mSectors || bytes > sectors * SECTOR_SIZE)) {
+			SDL_Log("\033[33mChunk %zu of %s points past the file, dropping it\033[0m", i, mPath.data());
+
+			mEntries[i] = {};
+		}
+	}
+
+	return true;
+}
+
+bool Region::writeEntry(const std::size_t slot) {
+	const auto& [sector, sectors, size] = mEntries[slot];
+
+	return SDL_SeekIO(mFile, static_cast<Sint64>(ENTRIES_OFFSET + slot * sizeof(entry)), SDL_IO_SEEK_SET) >= 0 &&
+	       SDL_WriteU32LE(mFile, sector) && SDL_WriteU32LE(mFile, sectors) && SDL_WriteU32LE(mFile, size);
+}
+
+std::uint32_t Region::allocate(const std::size_t slot, const std::uint32_t sectors) const {
+	// The sectors of the other chunks, the one being moved gives its own back
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> used;
+	for (std::size_t i = 0; i < mEntries.size(); ++i) {
+		if (i != slot && mEntries[i].size != 0) {
+			used.emplace_back(mEntries[i].sector, mEntries[i].sector + mEntries[i].sectors);
+		}
+	}
+
+	std::ranges::sort(used);
+
+	std::uint32_t free = 1;
+	for (const auto& [begin, end] : used) {
+		if (begin >= free + sectors) {
+			break;
+		}
+
+		free = std::max(free, end);
+	}
+
+	return free;
+}
+
+void Region::map() {
+#ifdef REGION_MMAP
+	const int file = open(mPath.data(), O_RDONLY);
+	if (file < 0) {
+		return;
+	}
+
+	struct stat info {};
+	if (fstat(file, &info) == 0 && info.st_size > 0) {
+		const auto size = static_cast<std::size_t>(info.st_size);
+		void* const mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+		if (mapping != MAP_FAILED) {
+			mMapping = static_cast<const std::byte*>(mapping);
+			mMappingSize = size;
+		}
+	}
+
+	// The mapping keeps the file open
+	close(file);
+#endif
+}
+
+void Region::unmap() {
+#ifdef REGION_MMAP
+	if (mMapping != nullptr) {
+		munmap(const_cast<std::byte*>(mMapping), mMappingSize);
+	}
+#endif
+
+	mMapping = nullptr;
+	mMappingSize = 0;
+}
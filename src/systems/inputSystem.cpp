@@ -11,6 +11,7 @@
 #include "opengl/texture.hpp"
 #include "registers.hpp"
 #include "scene.hpp"
+#include "scenes/level.hpp"
 #include "systems/UISystem.hpp"
 #include "systems/physicsSystem.hpp"
 #include "third_party/Eigen/Core"
@@ -56,26 +57,15 @@ void InputSystem::updateMouse(Scene* scene, const float) {
 	const Eigen::Vector2i blockPos{realX / Components::block::BLOCK_SIZE - (realX < 0),
 				       realY / Components::block::BLOCK_SIZE - (realY < 0)};
 
-	if (scene->getSignal(EventManager::RIGHT_CLICK_DOWN_SIGNAL)) {
-		scene->getSignal(EventManager::RIGHT_CLICK_DOWN_SIGNAL) = false;
+	if (scene->events().peek(EventManager::RIGHT_CLICK_EVENT)) {
+		scene->events().consume(EventManager::RIGHT_CLICK_EVENT);
 
-		for (const auto& [entity, block] : scene->view<Components::block>().each()) {
-			if (block.mPosition != blockPos) {
-				continue;
-			}
-
-			if (registers::CLICKABLES.contains(block.mType)) {
-				mGame->getSystemManager()->getUISystem()->addScreen(
-					registers::CLICKABLES.at(block.mType)());
-
-				goto afterPlace;
-			}
-
-			break;
+		const auto type = mGame->getLevel()->blockAt(blockPos);
+		if (registers::CLICKABLES.contains(type)) {
+			mGame->getSystemManager()->getUISystem()->addScreen(registers::CLICKABLES.at(type)());
+		} else {
+			tryPlace(scene, blockPos.template cast<int>());
 		}
-
-		tryPlace(scene, blockPos.template cast<int>());
-	afterPlace:;
 	}
 
 	static std::int64_t mLastHold = SDL_GetTicks();
@@ -86,93 +76,82 @@ void InputSystem::updateMouse(Scene* scene, const float) {
 
 		mDestruction.pos = blockPos;
 
-		if (!scene->getSignal(EventManager::LEFT_HOLD_SIGNAL)) {
+		if (!scene->events().signal(EventManager::LEFT_HOLD_SIGNAL)) {
 			return;
 		}
 
 		const auto pressLength =
-			(SDL_GetTicks() - std::max(mLastHold, scene->getSignal(EventManager::LEFT_HOLD_SIGNAL))) /
+			(SDL_GetTicks() - std::max(mLastHold, scene->events().signal(EventManager::LEFT_HOLD_SIGNAL))) /
 			50.0f;
-		for (const auto& [entity, block] : scene->view<Components::block>().each()) {
-			if (block.mPosition != blockPos) {
-				continue;
-			}
+		const auto type = mGame->getLevel()->blockAt(blockPos);
+		if (type == Components::AIR()) {
+			return;
+		}
 
-			const auto handItem =
-				static_cast<PlayerInventory*>(
-					scene->get<Components::inventory>(mGame->getPlayerID()).mInventory)
-					->getItem();
-			int handLevel = 0;
-			if (registers::MINING_LEVEL.contains(handItem)) {
-				handLevel = registers::MINING_LEVEL.at(handItem);
-			}
-			const auto [breakLevel, breakTime] = registers::BREAK_TIMES.at(block.mType);
-
-			bool getLoot = true;
-			int speed = 1;
-			if (breakLevel != 0) {
-				if (handLevel == 0) {
-					getLoot = false;
-				} else if (registers::MINING_SYSTEM.at(block.mType) !=
-					   registers::MINING_SYSTEM.at(handItem)) {
-					getLoot = false;
-				}
-			}
-			if (handLevel != 0 && registers::MINING_SYSTEM.contains(block.mType) &&
-			    registers::MINING_SYSTEM.at(block.mType) == registers::MINING_SYSTEM.at(handItem)) {
-				speed += handLevel;
+		const auto& inventory = scene->get<Components::inventory>(mGame->getPlayerID());
+		const auto handItem = static_cast<PlayerInventory*>(inventory.mInventory)->getItem();
+		int handLevel = 0;
+		if (registers::MINING_LEVEL.contains(handItem)) {
+			handLevel = registers::MINING_LEVEL.at(handItem);
+		}
+		const auto [breakLevel, breakTime] = registers::BREAK_TIMES.at(type);
+
+		bool getLoot = true;
+		int speed = 1;
+		if (breakLevel != 0) {
+			if (handLevel == 0) {
+				getLoot = false;
+			} else if (registers::MINING_SYSTEM.at(type) != registers::MINING_SYSTEM.at(handItem)) {
+				getLoot = false;
 			}
+		}
+		if (handLevel != 0 && registers::MINING_SYSTEM.contains(type) &&
+		    registers::MINING_SYSTEM.at(type) == registers::MINING_SYSTEM.at(handItem)) {
+			speed += handLevel;
+		}
 
-			const auto realBreakTime = breakTime / speed;
-			// Not enough time passed since press
-			if (pressLength < realBreakTime) {
-				mDestruction.render = true;
+		const auto realBreakTime = breakTime / speed;
+		// Not enough time passed since press
+		if (pressLength < realBreakTime) {
+			mDestruction.render = true;
 
-				const int stage = (pressLength / realBreakTime) * 10;
-				mDestruction.texture = mGame->getSystemManager()->getTexture(
-					"blocks/destroy_stage_" + std::to_string(stage) + ".png", true);
+			const int stage = (pressLength / realBreakTime) * 10;
+			mDestruction.texture = mGame->getSystemManager()->getTexture(
+				"blocks/destroy_stage_" + std::to_string(stage) + ".png", true);
 
-				break;
-			}
+			return;
+		}
+
+		const std::vector<std::pair<float, Components::Item>> defaultLoot = {{1.0f, type}};
+		const std::vector<std::pair<float, Components::Item>> noLoot = {};
+		const std::vector<std::pair<float, Components::Item>>& loot =
+			getLoot ? registers::LOOT_TABLES.contains(type) ? registers::LOOT_TABLES.at(type) : defaultLoot
+				: noLoot;
 
-			const std::vector<std::pair<float, Components::Item>> defaultLoot = {{1.0f, block.mType}};
-			const std::vector<std::pair<float, Components::Item>> noLoot = {};
-			const std::vector<std::pair<float, Components::Item>>& loot =
-				getLoot ? registers::LOOT_TABLES.contains(block.mType)
-						  ? registers::LOOT_TABLES.at(block.mType)
-						  : defaultLoot
-					: noLoot;
-
-			for (const auto& [chance, type] : loot) {
-				const float roll = SDL_randf();
-				if (roll >= chance) {
-					continue;
-				}
-
-				const auto item = scene->newEntity();
-				scene->emplace<Components::position>(
-					item, (scene->get<Components::block>(entity).mPosition.template cast<float>() +
-					       Eigen::Vector2f(0.40f, 0.40f)) *
-						      Components::block::BLOCK_SIZE);
-				scene->emplace<Components::item>(item, type);
-				scene->emplace<Components::texture>(
-					item, mGame->getSystemManager()->getTexture(registers::TEXTURES.at(type)),
-					0.3f);
-				scene->emplace<Components::velocity>(item, Eigen::Vector2f(0, 0));
-				const auto size =
-					Eigen::Vector2f(Components::block::BLOCK_SIZE, Components::block::BLOCK_SIZE) *
-					0.3f;
-				scene->emplace<Components::collision>(item, Eigen::Vector2f(0, 0), size);
+		for (const auto& [chance, drop] : loot) {
+			const float roll = SDL_randf();
+			if (roll >= chance) {
+				continue;
 			}
 
-			scene->erase(entity);
-			scene->getSignal(EventManager::LEFT_HOLD_SIGNAL) = 0;
+			const auto item = scene->newEntity();
+			scene->emplace<Components::position>(
+				item, (blockPos.template cast<float>() + Eigen::Vector2f(0.40f, 0.40f)) *
+					      Components::block::BLOCK_SIZE);
+			scene->emplace<Components::item>(item, drop);
+			scene->emplace<Components::texture>(
+				item, mGame->getSystemManager()->getTexture(registers::TEXTURES.at(drop)), 0.3f);
+			scene->emplace<Components::velocity>(item, Eigen::Vector2f(0, 0));
+			const Eigen::Vector2f size =
+				Eigen::Vector2f(Components::block::BLOCK_SIZE, Components::block::BLOCK_SIZE) * 0.3f;
+			scene->emplace<Components::collision>(item, Eigen::Vector2f(0, 0), size);
+		}
 
-			// Unused for the moment
-			scene->getSignal(PhysicsSystem::PHYSICS_DIRTY_SIGNAL) = true;
+		mGame->getLevel()->setBlock(blockPos, Components::AIR());
+		scene->events().signal(EventManager::LEFT_HOLD_SIGNAL) = 0;
 
-			break;
-		}
+		// Unused for the moment
+		scene->events().signal(PhysicsSystem::PHYSICS_DIRTY_SIGNAL) = true;
 	};
 
 	handleLeftClick();
@@ -206,10 +185,8 @@ void InputSystem::tryPlace(class Scene* scene, const Eigen::Vector2i& pos) {
 	using namespace Components;
 
 	auto* inv = static_cast<PlayerInventory*>(scene->get<Components::inventory>(mGame->getPlayerID()).mInventory);
-	for (const auto& block : scene->view<Components::block>()) {
-		if (scene->get<Components::block>(block).mPosition == pos) {
-			return;
-		}
+	if (mGame->getLevel()->blockAt(pos) != Components::AIR()) {
+		return;
 	}
 
 	const Eigen::Vector2f minB = pos.template cast<float>() * block::BLOCK_SIZE + Eigen::Vector2f(5, 5);
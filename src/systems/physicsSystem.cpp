@@ -5,7 +5,7 @@
 #include "game.hpp"
 #include "managers/entityManager.hpp"
 #include "managers/systemManager.hpp"
-#include "opengl/texture.hpp"
+#include "registers.hpp"
 #include "scene.hpp"
 #include "scenes/chunk.hpp"
 #include "scenes/level.hpp"
@@ -15,6 +15,7 @@
 
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_log.h>
+#include <cmath>
 #include <cstddef>
 #include <string>
 
@@ -24,6 +25,16 @@
 #include <format>
 #endif
 
+// The passes only run on the thread pool with PARALLEL_PHYSICS, there aren't enough moving entities for it to pay
+// off on every machine, see bench/thread_pool.cpp
+template <typename View, typename Func> static void forEach(const View& view, const Func& func) {
+#ifdef PARALLEL_PHYSICS
+	view.par_each(func);
+#else
+	view.each(func);
+#endif
+}
+
 // The physicsSystem is in charge of the collision and mouvements
 PhysicsSystem::PhysicsSystem() noexcept : mGame(Game::getInstance()) {}
 
@@ -31,55 +42,46 @@ void PhysicsSystem::update(Scene* scene, const float delta) {
 	constexpr const static float G = 1200.0f;
 	constexpr const static float jumpForce = 600.0f;
 
-	// Reset cache
-	for (auto& row : mCache.chunk) {
-		for (auto& block : row) {
-			block = 0;
-		}
+	if (!mGame->getSystemManager()->getUISystem()->empty()) {
+		return;
 	}
 
-	const auto leftChunk = (mGame->getLevel()->getPosition() - 1) * Chunk::CHUNK_WIDTH;
-
-	for (const auto& block : scene->view<Components::collision, Components::block>()) {
-		const auto pos = scene->get<Components::block>(block).mPosition;
-		const auto apos = pos.x() - leftChunk;
+	const auto moving = scene->view<Components::position, Components::velocity>();
+	const bool jump = scene->events().pressed(SDL_SCANCODE_SPACE);
+	// Entities past the simulation radius are frozen until the player comes back
+	const Level* const level = mGame->getLevel();
 
-		if (apos >= 48) {
-			continue;
-		}
-
-		mCache.chunk[apos][pos.y()] = block;
+	// The workers below only write to existing entries, inserting would rehash the map under their feet
+	for (const auto entity : moving) {
+		mCache.onGround.try_emplace(entity, false);
 	}
 
-	if (!mGame->getSystemManager()->getUISystem()->empty()) {
-		return;
-	}
+	// Every entity only touches its own velocity and cache entry, and the terrain is only read, so this can run on
+	// the thread pool
+	const auto fall = [&](const EntityID entity, Components::position& position,
+			      Components::velocity& velocityComponent) {
+		if (!level->simulated(position.mPosition)) {
+			return;
+		}
 
-	const auto blocks = scene->view<Components::collision, Components::block>();
-	for (const auto entity : scene->view<Components::position, Components::velocity>()) {
 		bool onGround = false;
-
-		if (scene->get<Components::velocity>(entity).mVelocity.y() < 1.0f) {
-			// Look cache for bellow block
-			if (!mCache.lastAbove.contains(entity) ||
-			    !scene->contains<Components::block>(mCache.lastAbove[entity]) ||
-			    !(onGround = collidingBellow(scene, entity, mCache.lastAbove[entity]))) {
-				for (const auto& block : blocks) {
-					if (collidingBellow(scene, entity, block)) {
-						onGround = true;
-						mCache.lastAbove[entity] = block;
-
-						break;
-					}
-				}
-			}
+		auto& velocity = velocityComponent.mVelocity;
+
+		if (velocity.y() < 1.0f) {
+			// Only the blocks the entity covers, down to half a pixel under its feet, can hold it
+			const auto& collision = scene->get<Components::collision>(entity);
+			const Eigen::Vector2f corner = position.mPosition + collision.mOffset;
+			const Eigen::Vector2f min = corner - Eigen::Vector2f(0.0f, 0.5f);
+			const Eigen::Vector2f max = corner + collision.mSize;
+
+			eachTile(min, max, [&](const Eigen::Vector2i& block, const box& blockCollision) {
+				onGround = onGround || collidingBellow(scene, entity, block, blockCollision);
+			});
 		}
 
-		auto& velocity = scene->get<Components::velocity>(entity).mVelocity;
 		if (onGround) {
-			// We can jump IF the entity is a misc entity with the jump flag, and the up key is pressed, and
-			// we are on the ground
-			if (entity == mGame->getPlayerID() && scene->getSignal(SDL_SCANCODE_SPACE)) {
+			// We can jump IF the entity has the jump tag, and the up key is pressed, and we are on the ground
+			if (jump && scene->contains<Components::jump>(entity)) {
 				velocity.y() = jumpForce;
 			} else {
 				velocity.y() = 0.0f;
@@ -88,68 +90,87 @@ void PhysicsSystem::update(Scene* scene, const float delta) {
 			velocity.y() -= G * delta;
 		}
 
-		if (scene->contains<Components::animated_texture>(entity)) {
-			auto& texture = scene->get<Components::animated_texture>(entity);
-			if (!onGround) {
-				texture.mSelect = 2 * 8 + (velocity.y() > 0);
+		mCache.onGround.find(entity)->second = onGround;
+	};
+	forEach(moving, fall);
+
+	// The walk cycle is shared, so the few animated entities are done here
+	for (const auto& [entity, velocityComponent, texture] :
+	     scene->view<Components::velocity, Components::animated_texture>().each()) {
+		const auto& velocity = velocityComponent.mVelocity;
+		if (!mCache.onGround.contains(entity)) {
+			continue;
+		}
+
+		if (!mCache.onGround[entity]) {
+			texture.mSelect = 2 * 8 + (velocity.y() > 0);
+		} else {
+			static float step = 0;
+			if (nearZero(velocity.x())) {
+				texture.mSelect = 0;
+				step = 0;
 			} else {
-				static float step = 0;
-				if (nearZero(velocity.x())) {
-					texture.mSelect = 0;
-					step = 0;
-				} else {
-					step += delta * 10;
-					if (step >= 4.0f) {
-						step = 0.0f;
-					}
-
-					texture.mSelect = 8 + static_cast<int>(step);
+				step += delta * 10;
+				if (step >= 4.0f) {
+					step = 0.0f;
 				}
-			}
 
-			if (!nearZero(velocity.x())) {
-				// Flip if going left
-				texture.mFlip = velocity.x() < 0;
+				texture.mSelect = 8 + static_cast<int>(step);
 			}
 		}
 
-		scene->get<Components::position>(entity).mPosition += velocity * delta;
-		velocity.x() *= 0.7;
+		if (!nearZero(velocity.x())) {
+			// Flip if going left
+			texture.mFlip = velocity.x() < 0;
+		}
 	}
 
+	const auto move = [scene, delta, level](const EntityID entity, const Components::position& position,
+						Components::velocity& velocity) {
+		if (!level->simulated(position.mPosition)) {
+			return;
+		}
+
+		// Entities at rest keep their change tick, so `collide` can skip them
+		if (velocity.mVelocity != Eigen::Vector2f::Zero()) {
+			scene->getMut<Components::position>(entity).mPosition += velocity.mVelocity * delta;
+		}
+
+		velocity.mVelocity.x() *= 0.7;
+		if (nearZero(velocity.mVelocity.x())) {
+			velocity.mVelocity.x() = 0.0f;
+		}
+	};
+	forEach(moving, move);
+
 	itemPhysics(scene);
 }
 
 void PhysicsSystem::collide(Scene* scene) {
-	const auto leftChunk = (mGame->getLevel()->getPosition() - 1) * Chunk::CHUNK_WIDTH;
 	if (!mGame->getSystemManager()->getUISystem()->empty()) {
 		return;
 	}
 
-	for (const auto& block : scene->view<Components::collision, Components::block>()) {
-		if (AABBxAABB(scene, mGame->getPlayerID(), block)) {
-			pushBack(scene, mGame->getPlayerID(), block);
-		}
-	}
+	// A terrain change can land on anything, otherwise only the entities that moved since the last run can collide
+	const auto since = mCache.lastCollide;
+	mCache.lastCollide = scene->advanceTick();
+	const auto revision = mGame->getLevel()->getRevision();
+	const bool everything = mCache.revision != revision;
+	mCache.revision = revision;
 
-	// Get a list of all the entities we need to check
 	const auto entities = scene->view<Components::collision, Components::position>();
-	for (const auto& entity : entities) {
-		const auto pos = scene->get<Components::position>(entity).mPosition;
-		const auto apos = (pos.x() / Components::block::BLOCK_SIZE) - leftChunk;
+	const auto moved = everything ? entities : entities.changed<Components::position>(since);
 
-		if (apos >= 48) {
-			SDL_Log("Error! Block out of cache range, ignoring");
-			continue;
-		}
-
-		const auto cell = mCache.chunk[apos][pos.y() / Components::block::BLOCK_SIZE];
+	for (const auto& entity : moved) {
+		const auto& collision = scene->get<Components::collision>(entity);
+		const Eigen::Vector2f min = scene->get<Components::position>(entity).mPosition + collision.mOffset;
 
-		if (cell) {
-			if (AABBxAABB(scene, entity, cell)) {
-				pushBack(scene, entity, cell);
+		// Every push moves the entity, so each block is tested against where the last one left it
+		eachTile(min, min + collision.mSize, [&](const Eigen::Vector2i& block, const box& blockCollision) {
+			if (AABBxAABB(scene, entity, block, blockCollision)) {
+				pushBack(scene, entity, block, blockCollision);
 			}
-		}
+		});
 	}
 
 	// Debug editor
@@ -160,7 +181,7 @@ void PhysicsSystem::collide(Scene* scene) {
 	ImGui::End();
 
 	if (editor) {
-		scene->getSignal("collisionEditor"_u) = true;
+		scene->events().signal(EventBus::Signal::COLLISION_EDITOR) = true;
 
 		ImGui::Begin("Collision editor");
 
@@ -172,12 +193,6 @@ void PhysicsSystem::collide(Scene* scene) {
 							    -10000.0f, 10000.0f);
 				}
 
-				if (scene->contains<Components::block>(entity)) {
-					ImGui::SliderInt2(std::format("Position for entity {}", entity).data(),
-							  scene->get<Components::block>(entity).mPosition.data(), -10,
-							  10);
-				}
-
 				ImGui::SliderFloat2(std::format("Offset for entity {}", entity).data(),
 						    scene->get<Components::collision>(entity).mOffset.data(), -500,
 						    500);
@@ -195,17 +210,43 @@ void PhysicsSystem::collide(Scene* scene) {
 #endif
 }
 
-bool PhysicsSystem::AABBxAABB(const Scene* scene, const EntityID entityID, const EntityID blockID) const {
+const PhysicsSystem::box* PhysicsSystem::tileCollision(const Components::Item type) {
+	const static box full = {Eigen::Vector2f(0.0f, 0.0f),
+				 Eigen::Vector2f(Components::block::BLOCK_SIZE, Components::block::BLOCK_SIZE)};
+
+	if (const auto custom = registers::COLLISION_BOXES.find(type); custom != registers::COLLISION_BOXES.end()) {
+		// Torches and such have an empty box
+		const auto& size = custom->second.second;
+
+		return size.x() == 0 || size.y() == 0 ? nullptr : &custom->second;
+	}
+
+	return &full;
+}
+
+template <typename Function>
+void PhysicsSystem::eachTile(const Eigen::Vector2f& min, const Eigen::Vector2f& max, Function&& function) const {
+	constexpr const static float size = Components::block::BLOCK_SIZE;
+
+	const Eigen::Vector2i first(std::floor(min.x() / size), std::floor(min.y() / size));
+	const Eigen::Vector2i last(std::floor(max.x() / size), std::floor(max.y() / size));
+
+	mGame->getLevel()->eachBlock(first, last, [&](const Eigen::Vector2i& block, const Components::Item type) {
+		if (const box* const blockCollision = tileCollision(type)) {
+			function(block, *blockCollision);
+		}
+	});
+}
+
+bool PhysicsSystem::AABBxAABB(const Scene* scene, const EntityID entityID, const Eigen::Vector2i& block,
+			      const box& blockCollision) const {
 	using namespace Components;
 
 	const Eigen::Vector2f minA = scene->get<position>(entityID).mPosition + scene->get<collision>(entityID).mOffset;
 	const Eigen::Vector2f maxA = minA + scene->get<collision>(entityID).mSize;
 
-	const auto& blockCollision = scene->get<collision>(blockID);
-	Eigen::Vector2f minB = scene->get<block>(blockID).mPosition.template cast<float>() * block::BLOCK_SIZE;
-	minB += blockCollision.mOffset;
-
-	const Eigen::Vector2f maxB = minB + blockCollision.mSize;
+	const Eigen::Vector2f minB = block.template cast<float>() * block::BLOCK_SIZE + blockCollision.first;
+	const Eigen::Vector2f maxB = minB + blockCollision.second;
 
 	// If one of these four are true, it means the cubes are not intersecting
 	const bool notIntercecting = maxA.x() <= minB.x()     // Amax to the left of Bmin
@@ -217,7 +258,8 @@ bool PhysicsSystem::AABBxAABB(const Scene* scene, const EntityID entityID, const
 	return !notIntercecting;
 }
 
-bool PhysicsSystem::collidingBellow(const class Scene* scene, const EntityID entityID, const EntityID blockID) const {
+bool PhysicsSystem::collidingBellow(const class Scene* scene, const EntityID entityID, const Eigen::Vector2i& block,
+				    const box& blockCollision) const {
 	using namespace Components;
 
 	const Eigen::Vector2f minEntity =
@@ -226,12 +268,9 @@ bool PhysicsSystem::collidingBellow(const class Scene* scene, const EntityID ent
 	// They are definetly not touching the ground when having a upwards velocity
 	const Eigen::Vector2f maxEntity = minEntity + scene->get<collision>(entityID).mSize;
 
-	const auto& blockCollision = scene->get<collision>(blockID);
-	const Eigen::Vector2f minBlock =
-		scene->get<block>(blockID).mPosition.template cast<float>() * block::BLOCK_SIZE +
-		blockCollision.mOffset;
+	const Eigen::Vector2f minBlock = block.template cast<float>() * block::BLOCK_SIZE + blockCollision.first;
 
-	const Eigen::Vector2f maxBlock = minBlock + blockCollision.mSize;
+	const Eigen::Vector2f maxBlock = minBlock + blockCollision.second;
 
 	// on a x level
 	const bool notIntercecting = maxEntity.x() - 6 <= minBlock.x()	  // entity to the left of b
@@ -270,7 +309,8 @@ bool PhysicsSystem::collidingBellow(const class Scene* scene, const EntityID ent
  * 2. Both aren't static, thus push back both by half the overlap
  * (If the objects are both stationary, pass)
  */
-void PhysicsSystem::pushBack(class Scene* scene, const EntityID entity, EntityID block) {
+void PhysicsSystem::pushBack(class Scene* scene, const EntityID entity, const Eigen::Vector2i& block,
+			     const box& blockCollision) {
 	/*
 	 * Thx stack https://gamedev.stackexchange.com/questions/18302/2d-platformer-collisions
 	 * See
@@ -284,19 +324,13 @@ void PhysicsSystem::pushBack(class Scene* scene, const EntityID entity, EntityID
 	const Eigen::Vector2f centerEntity = leftEntity + scene->get<Components::collision>(entity).mSize / 2;
 
 	// And the position of the block
-	const auto& blockCollision = scene->get<Components::collision>(block);
-	const auto& blockTexture = scene->get<Components::texture>(block);
-	const auto& blockPosition = scene->get<Components::block>(block).mPosition;
-
 	const Eigen::Vector2f leftBlock =
-		Eigen::Vector2f(static_cast<float>(blockPosition.x()) * blockTexture.mTexture->getWidth(),
-				static_cast<float>(blockPosition.y()) * blockTexture.mTexture->getHeight()) +
-		blockCollision.mOffset;
-	const Eigen::Vector2f centerB = leftBlock + scene->get<Components::collision>(block).mSize / 2;
+		block.template cast<float>() * Components::block::BLOCK_SIZE + blockCollision.first;
+	const Eigen::Vector2f centerB = leftBlock + blockCollision.second / 2;
 
 	const Eigen::Vector2f distance = centerEntity - centerB;
 	const Eigen::Vector2f minDistance =
-		(scene->get<Components::collision>(entity).mSize + blockCollision.mSize) / 2;
+		(scene->get<Components::collision>(entity).mSize + blockCollision.second) / 2;
 
 	SDL_assert(!(SDL_abs(distance.x()) > minDistance.x() || SDL_abs(distance.y()) > minDistance.y()) &&
 		   "The objects are not colliding?");
@@ -307,10 +341,11 @@ void PhysicsSystem::pushBack(class Scene* scene, const EntityID entity, EntityID
 
 	const Eigen::Vector2f depth = Eigen::Vector2f(depthX, depthY);
 
+	// Marked as changed, so the entity gets checked again next time
 	if (SDL_abs(depth.x()) <= SDL_abs(depth.y())) {
-		scene->get<Components::position>(entity).mPosition.x() += depth.x();
+		scene->getMut<Components::position>(entity).mPosition.x() += depth.x();
 	} else {
-		scene->get<Components::position>(entity).mPosition.y() += depth.y();
+		scene->getMut<Components::position>(entity).mPosition.y() += depth.y();
 	}
 }
 
@@ -324,7 +359,7 @@ void PhysicsSystem::itemPhysics(class Scene* scene) {
 			     scene->get<Components::position>(entity).mPosition)
 				    .squaredNorm() < PICK_UP_RANGE_SQ) {
 				if (scene->get<Components::inventory>(entity).mInventory->tryPick(scene, item)) {
-					scene->erase(item);
+					scene->deferErase(item);
 
 					break;
 				}
@@ -16,11 +16,14 @@
 #include "opengl/ubo.hpp"
 #include "registers.hpp"
 #include "scene.hpp"
+#include "scenes/chunk.hpp"
+#include "scenes/level.hpp"
 #include "third_party/Eigen/Geometry"
 #include "third_party/glad/glad.h"
 #include "utils.hpp"
 
 #include <SDL3/SDL.h>
+#include <algorithm>
 #include <cstddef>
 #include <memory>
 #include <span>
@@ -267,31 +270,15 @@ void RenderSystem::draw(Scene* scene) {
 	const Eigen::Vector2f cameraOffset = -scene->get<Components::position>(mGame->getPlayerID()).mPosition +
 					     Eigen::Vector2f(mWidth, mHeight) / 2;
 
-	const Eigen::Vector2f screenSize = mGame->getSystemManager()->getDemensions() / Components::block::BLOCK_SIZE;
-	const Eigen::Vector2f playerBlockPos = (scene->get<Components::position>(mGame->getPlayerID()).mPosition +
-						scene->get<Components::collision>(mGame->getPlayerID()).mOffset) /
-					       Components::block::BLOCK_SIZE;
-
-	// Screen top, bottom...
-	const float sb = playerBlockPos.y() - screenSize.y() / 2 - 1;
-	const float st = playerBlockPos.y() + screenSize.y() / 2;
-	const float sl = playerBlockPos.x() - screenSize.x() / 2 - 2;
-	const float sr = playerBlockPos.x() + screenSize.x() / 2;
+	updateBlocks();
 
 	// 1. Blitz the new blocks onto our texture atlas
 	Shader* shader = mShaders->get("blitz.vert", "block.frag");
 	shader->activate();
-	const auto blocks = scene->view<Components::block>();
-	for (const auto& [_, block] : blocks.each()) {
-		const auto& pos = block.mPosition;
-
-		// Culling
-		if (!(pos.y() >= sb && pos.y() <= st && pos.x() <= sr && pos.x() >= sl)) {
-			continue;
-		}
-
-		mTextures->blitzAtlas(block.mType);
+	for (const auto type : mBlocks.blitz) {
+		mTextures->blitzAtlas(type);
 	}
+	mBlocks.blitz.clear();
 
 	mFramebuffer->bind();
 
@@ -301,20 +288,6 @@ void RenderSystem::draw(Scene* scene) {
 	shader->set("texture_diffuse"_u, 0);
 	shader->set("offset"_u, cameraOffset);
 
-	std::vector<GLint> data;
-	for (const auto& [_, block] : blocks.each()) {
-		const auto& pos = block.mPosition;
-
-		// Culling
-		if (!(pos.y() >= sb && pos.y() <= st && pos.x() <= sr && pos.x() >= sl)) {
-			continue;
-		}
-
-		data.emplace_back(pos.x());
-		data.emplace_back(pos.y());
-		data.emplace_back(static_cast<GLint>(etoi(block.mType)));
-	}
-
 	auto* const atlas = mTextures->getAtlas();
 	atlas->activate(0);
 
@@ -325,7 +298,8 @@ void RenderSystem::draw(Scene* scene) {
 
 		glGenBuffers(1, &instanceVBO);
 		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(GLint) * data.size(), data.data(), GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(GLint) * mBlocks.data.size(), mBlocks.data.data(),
+			     GL_DYNAMIC_DRAW);
 
 		mMesh->addAttribArray(instanceVBO, [] {
 			glEnableVertexAttribArray(3);
@@ -334,10 +308,15 @@ void RenderSystem::draw(Scene* scene) {
 		});
 	}
 
-	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLint) * data.size(), data.data(), GL_STATIC_DRAW);
+	// Every loaded block is drawn, the ones off screen are clipped by the GPU
+	if (mBlocks.dirty) {
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(GLint) * mBlocks.data.size(), mBlocks.data.data(),
+			     GL_DYNAMIC_DRAW);
+		mBlocks.dirty = false;
+	}
 
-	mMesh->drawInstanced(data.size() / 3);
+	mMesh->drawInstanced(mBlocks.data.size() / 3);
 
 	// Draw other textures
 	shader = mShaders->get("single_block.vert", "block.frag");
@@ -396,7 +375,7 @@ void RenderSystem::draw(Scene* scene) {
 	ImGui::End();
 
 	// Debug layer rendering
-	if (scene->getSignal("collisionEditor"_u) || hitbox) {
+	if (scene->events().signal(EventBus::Signal::COLLISION_EDITOR) || hitbox) {
 		GLint mode[2];
 		if (hitbox && glPolygonMode != nullptr) {
 			glGetIntegerv(GL_POLYGON_MODE, mode);
@@ -437,6 +416,29 @@ void RenderSystem::draw(Scene* scene) {
 #endif
 }
 
+void RenderSystem::updateBlocks() {
+	const Level* const level = mGame->getLevel();
+	if (level->getRevision() == mBlocks.revision) {
+		return;
+	}
+
+	mBlocks.revision = level->getRevision();
+	mBlocks.data.clear();
+	mBlocks.dirty = true;
+
+	level->eachRenderedChunk([this](const Chunk& chunk) {
+		chunk.each([this](const Eigen::Vector2i& position, const Components::Item type) {
+			mBlocks.data.emplace_back(position.x());
+			mBlocks.data.emplace_back(position.y());
+			mBlocks.data.emplace_back(static_cast<GLint>(etoi(type)));
+
+			if (std::ranges::find(mBlocks.blitz, type) == mBlocks.blitz.end()) {
+				mBlocks.blitz.emplace_back(type);
+			}
+		});
+	});
+}
+
 void RenderSystem::present() const { mFramebuffer->swap(); }
 
 void RenderSystem::swapWindow() const { SDL_GL_SwapWindow(mWindow.get()); }
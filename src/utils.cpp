@@ -2,14 +2,8 @@
 
 #include <SDL3/SDL.h>
 #include <string>
-#include <vector>
-
-namespace utils {
-class sparse_set_interface;
-}
 
 void* loadFile(const char* file, size_t* datasize) { return SDL_LoadFile(file, datasize); }
-std::vector<int*> mViewCache;
 
 std::string getBasePath_impl() {
 	const char* basepath = SDL_GetBasePath();
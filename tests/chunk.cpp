@@ -0,0 +1,101 @@
+// Neighbouring chunks have to come out the same whichever is generated first, and whether on the main thread or
+// on a worker, or the trees on the border would be cut off
+
+#include "components/noise.hpp"
+#include "items.hpp"
+#include "misc/snapshot.hpp"
+#include "registers.hpp"
+#include "scenes/chunk.hpp"
+#include "third_party/Eigen/Core"
+
+#include <SDL3/SDL.h>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+[[nodiscard]] std::vector<std::byte> encode(const Chunk& chunk) {
+	utils::snapshot_writer writer;
+	chunk.save(writer);
+
+	return writer.release();
+}
+
+// Counts the trees rooted in `left` that grow into `right`, and the blocks of them missing on the right side
+void borderTrees(const Chunk& left, const Chunk& right, int& trees, int& missing) {
+	const auto& tree = registers::SURFACE_STRUCTURES[0].second;
+	const int edge = static_cast<int>(right.getPosition() * Chunk::CHUNK_WIDTH);
+
+	for (int x = edge - Chunk::CHUNK_WIDTH; x < edge; ++x) {
+		for (int y = 1; y < Chunk::MAX_HEIGHT; ++y) {
+			// The lowest log is right above the block the tree grew on
+			if (left.getBlock(Eigen::Vector2i(x, y)) != Components::Item::OAK_LOG ||
+			    left.getBlock(Eigen::Vector2i(x, y - 1)) == Components::Item::OAK_LOG) {
+				continue;
+			}
+
+			bool crosses = false;
+			for (const auto& [type, offset] : tree) {
+				const Eigen::Vector2i position = Eigen::Vector2i(x, y - 1) + offset;
+				if (right.contains(position)) {
+					crosses = true;
+					missing += right.getBlock(position) == Components::Item::AIR;
+				}
+			}
+
+			trees += crosses;
+		}
+	}
+}
+} // namespace
+
+int main() {
+	int failures = 0;
+	int trees = 0;
+	int missing = 0;
+
+	for (std::uint64_t seed = 1; seed <= 8; ++seed) {
+		const NoiseGenerator noise(seed);
+
+		for (std::int64_t position = -8; position < 8; ++position) {
+			// Left first on the main thread
+			const Chunk left(&noise, position);
+			const Chunk right(&noise, position + 1);
+
+			// Right first on a worker, with a copy of the noise like `Level::request`
+			std::unique_ptr<Chunk> worker;
+			std::thread([&worker, copy = noise, position] {
+				worker = std::make_unique<Chunk>(&copy, position + 1);
+			}).join();
+			const Chunk after(&noise, position);
+
+			if (encode(left) != encode(after) || encode(right) != encode(*worker)) {
+				SDL_Log("\033[31mChunks %" PRIi64 " and %" PRIi64 " of seed %" PRIu64
+					" depend on the order\033[0m",
+					position, position + 1, seed);
+				++failures;
+			}
+
+			borderTrees(left, right, trees, missing);
+		}
+	}
+
+	// Otherwise nothing above crossed a border
+	if (trees == 0) {
+		SDL_Log("\033[31mNo tree grew over a chunk border\033[0m");
+		++failures;
+	}
+
+	if (missing != 0) {
+		SDL_Log("\033[31m%d blocks of the trees over a border are missing\033[0m", missing);
+		++failures;
+	}
+
+	SDL_Log("%d trees over a border, %d failures", trees, failures);
+
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
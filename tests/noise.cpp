@@ -0,0 +1,58 @@
+// The noise is sampled a register of samples at a time, with the scalar loop for what is left over. A single sample
+// only goes through the scalar loop, so both have to agree to the bit or the terrain would depend on where a row
+// starts, the heights are truncated and the caves and ores are thresholds
+
+#include "components/noise.hpp"
+
+#include <SDL3/SDL.h>
+#include <bit>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <vector>
+
+namespace {
+using Feature = NoiseGenerator::Feature;
+
+// Long enough for a few registers and a tail
+constexpr const static std::size_t SAMPLES = 133;
+} // namespace
+
+int main() {
+	const NoiseGenerator noise(1234);
+	std::vector<float> row(SAMPLES);
+	std::vector<float> column(SAMPLES);
+	int failures = 0;
+
+	// The octaves the chunks use, and positions around 0 and far from spawn
+	using octaves = NoiseGenerator::octaves;
+	for (const octaves shape : {octaves{64, 3}, octaves{32, 3}, octaves{16, 2}}) {
+		for (const std::int64_t x : {-5000LL, -17LL, 0LL, 4099LL, 1LL << 40}) {
+			noise.getNoise(Feature::HEIGHT, x, row, shape);
+			noise.getNoise(Feature::CAVE, x, x / 3, column, shape);
+
+			for (std::size_t i = 0; i < SAMPLES; ++i) {
+				float single = 0.0f;
+				noise.getNoise(Feature::HEIGHT, x + i, std::span(&single, 1), shape);
+				if (std::bit_cast<std::uint32_t>(single) != std::bit_cast<std::uint32_t>(row[i])) {
+					SDL_Log("\033[31mRow sample %zu from %" PRIi64 " is %a, alone %a\033[0m", i, x,
+						row[i], single);
+					++failures;
+				}
+
+				noise.getNoise(Feature::CAVE, x, x / 3 + i, std::span(&single, 1), shape);
+				if (std::bit_cast<std::uint32_t>(single) != std::bit_cast<std::uint32_t>(column[i])) {
+					SDL_Log("\033[31mColumn sample %zu from %" PRIi64 " is %a, alone %a\033[0m", i,
+						x, column[i], single);
+					++failures;
+				}
+			}
+		}
+	}
+
+	SDL_Log("%d samples differ", failures);
+
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}